@@ -7,6 +7,8 @@
 
 #include "Actor.hpp"
 #include "Engine.hpp"
+#include "ScriptWorkers.hpp"
+#include "PhysicsPool.hpp"
 
 using namespace std;
 
@@ -35,6 +37,10 @@ void Actor::callUpdate() {
     sort(keys.begin(), keys.end());
     
     for (const auto& key : keys) {
+        // Components adopted by a script worker are updated by ScriptWorkers::run
+        if (components[key]->state() != Component::lua_state) {
+            continue;
+        }
         Component::callOnUpdate(components[key], name);
     }
 }
@@ -48,6 +54,9 @@ void Actor::callLateUpdate() {
     sort(keys.begin(), keys.end());
     
     for (const auto& key : keys) {
+        if (components[key]->state() != Component::lua_state) {
+            continue;
+        }
         Component::callOnLateUpdate(components[key], name);
     }
 }
@@ -55,10 +64,10 @@ void Actor::callLateUpdate() {
 
 luabridge::LuaRef Actor::GetComponentByKey(const std::string& key) {
     auto it = components.find(key);
-    if (it != components.end()) {
+    if (it != components.end() && it->second->state() == Component::lua_state) {
         return *(it->second);
     }
-    return luabridge::LuaRef(components.begin()->second->state());
+    return luabridge::LuaRef(Component::lua_state);
 }
 
 
@@ -75,6 +84,11 @@ luabridge::LuaRef Actor::GetComponent(const std::string &type_name) {
             continue; // Skip components that are scheduled for removal
         }
         
+        // Worker-owned components can't be handed to the main state
+        if (components[key]->state() != Component::lua_state) {
+            continue;
+        }
+        
         luabridge::LuaRef comp_type = (*components[key])["__type"];
         if (comp_type.isString() && comp_type.cast<std::string>() == type_name) {
             return *components[key];
@@ -88,13 +102,42 @@ luabridge::LuaRef Actor::GetComponent(const std::string &type_name) {
     }
     
     // Return nil if no component is found
-    return luabridge::LuaRef(components.begin()->second->state());
+    return luabridge::LuaRef(Component::lua_state);
+}
+
+
+int Actor::GetComponentLocal(lua_State* L) {
+    std::string type_name = luaL_checkstring(L, 2);
+    
+    // components is a std::map, so this already walks the keys in order
+    for (const auto& [key, component] : components) {
+        if (component->state() != L) {
+            continue;
+        }
+        if (std::find(to_remove_components.begin(), to_remove_components.end(), key) != to_remove_components.end()) {
+            continue;
+        }
+        
+        luabridge::LuaRef comp_type = (*component)["type"];
+        if (comp_type.isString() && comp_type.cast<std::string>() == type_name) {
+            component->push(L);
+            return 1;
+        }
+    }
+    
+    if (type_name == "Rigidbody" && rigidbody != nullptr && ScriptWorkers::owns(L, this)) {
+        luabridge::Stack<Rigidbody*>::push(L, rigidbody);
+        return 1;
+    }
+    
+    lua_pushnil(L);
+    return 1;
 }
 
 
 luabridge::LuaRef Actor::GetComponents(const std::string &type) {
     // Create a new table to hold the components
-    luabridge::LuaRef result = luabridge::newTable(components.begin()->second->state());
+    luabridge::LuaRef result = luabridge::newTable(Component::lua_state);
     int index = 1; // Lua tables are 1-indexed
     
     // Sort keys for deterministic order
@@ -106,6 +149,10 @@ luabridge::LuaRef Actor::GetComponents(const std::string &type) {
     
     // Find all components of the given type
     for (const auto& key : keys) {
+        if (components[key]->state() != Component::lua_state) {
+            continue;
+        }
+        
         // Try __type field first (for Lua components)
         luabridge::LuaRef comp_type = (*components[key])["__type"];
         if (comp_type.isString() && comp_type.cast<std::string>() == type) {
@@ -128,6 +175,7 @@ luabridge::LuaRef Actor::GetComponents(const std::string &type) {
 
 void Template::readTemplates(){
     loadedTemplates.clear();
+    templatePaths.clear();
     
     string templatePath = "resources/actor_templates";
     
@@ -135,47 +183,66 @@ void Template::readTemplates(){
         return;
     }
     
+    // Templates are parsed on first use so their component types load lazily too
     for(const auto& entry : filesystem::directory_iterator(templatePath)){
-        string filePath = entry.path().string();
-        string fileName = entry.path().stem().string();
-        
-        rapidjson::Document doc;
-        EngineHelper::ReadJsonFile(filePath, doc);
-        
-        Actor templateActor;
-        
-        if(doc.HasMember("name") && doc["name"].IsString()){
-            templateActor.name = doc["name"].GetString();
-        }
-        
-        if(doc.HasMember("components") && doc["components"].IsObject()){
-            for (auto& comp : doc["components"].GetObject()) {
-                string key = comp.name.GetString();
-                auto& value = comp.value;
-                
-                if (value.HasMember("type") && value["type"].IsString()) {
-                    std::string type = value["type"].GetString();
-                    templateActor.components[key] = Component::applyComponent(type, key);
-                    Component::applyOverrides(templateActor.components[key], value);
-                }
+        templatePaths[entry.path().stem().string()] = entry.path().string();
+    }
+}
+
+
+void Template::loadTemplate(const std::string& templateName){
+    if (loadedTemplates.find(templateName) != loadedTemplates.end()) {
+        return;
+    }
+    
+    auto path = templatePaths.find(templateName);
+    if (path == templatePaths.end()) {
+        std::cout << "error: template " << templateName << " is missing";
+        exit(0);
+    }
+    
+    rapidjson::Document doc;
+    EngineHelper::ReadJsonFile(path->second, doc);
+    
+    Actor templateActor;
+    
+    if(doc.HasMember("name") && doc["name"].IsString()){
+        templateActor.name = doc["name"].GetString();
+    }
+    
+    if(doc.HasMember("components") && doc["components"].IsObject()){
+        for (auto& comp : doc["components"].GetObject()) {
+            string key = comp.name.GetString();
+            auto& value = comp.value;
+            
+            if (value.HasMember("type") && value["type"].IsString()) {
+                std::string type = value["type"].GetString();
+                templateActor.components[key] = Component::applyComponent(type, key);
+                Component::applyOverrides(templateActor.components[key], value);
             }
         }
-        
-        loadedTemplates[fileName] = templateActor;
+    }
+    
+    loadedTemplates[templateName] = templateActor;
+}
+
 
+void Template::preloadTemplates(const rapidjson::Value& template_list){
+    for(const auto& templateName : template_list.GetArray()){
+        if(templateName.IsString()){
+            loadTemplate(templateName.GetString());
+        }
     }
 }
 
 
 Actor Template::GetTemplated(std::string templateName) {
-    if (loadedTemplates.find(templateName) == loadedTemplates.end()) {
-        std::cout << "error: template " << templateName << " is missing";
-        exit(0);
-    }
+    loadTemplate(templateName);
     
     Actor actor;
     
     actor.name = loadedTemplates[templateName].name;
+    actor.template_name = templateName;
     
     for (const auto& [key, templateComp] : loadedTemplates[templateName].components) {
         actor.components[key] = Component::cloneComponent(templateComp, key);
@@ -227,110 +294,63 @@ void Actor::processAddedComponents() {
 }
 
 
-void Actor::onTriggerEnter(Collision collision){
-    vector<string> keys;
-    for (const auto& [key, _] : components) {
-        keys.push_back(key);
-    }
-    std::sort(keys.begin(), keys.end());
+void Actor::deliverContacts(const ContactEvent* events, size_t count){
+    static const char* const callback_names[] = {"OnCollisionEnter", "OnCollisionExit", "OnTriggerEnter", "OnTriggerExit"};
     
-    for(const auto& key : keys){
-        luabridge::LuaRef component = *(components[key]);
-        luabridge::LuaRef enabled = component["enabled"];
-        
-        if(!enabled){
-            continue;
-        }
-                
-        luabridge::LuaRef onTriggerEnter = component["OnTriggerEnter"];
-        if(onTriggerEnter.isFunction()){
-            try{
-                onTriggerEnter(component, collision);
-            }catch (const luabridge::LuaException& e) {
-                std::cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << std::endl;
-            }
+    size_t enter_count = 0;
+    for (size_t i = 0; i < count; i++){
+        if (events[i].kind == ContactEvent::CollisionEnter){
+            enter_count++;
         }
     }
-
-}
-
-void Actor::onTriggerExit(Collision collision){
-    vector<std::string> keys;
-    for (const auto& [key, _] : components) {
-        keys.push_back(key);
-    }
-    std::sort(keys.begin(), keys.end());
     
-    for (const auto& key : keys) {
-        luabridge::LuaRef component = *(components[key]);
-        luabridge::LuaRef enabled = component["enabled"];
-        
-        if(!enabled){
-            continue;
-        }
+    // components is a std::map, so it already walks in key order
+    for (const auto& [key, component_ref] : components) {
+        const luabridge::LuaRef& component = *component_ref;
+        bool batched = enter_count > 0 && component["OnCollisionsEnter"].isFunction();
         
-        luabridge::LuaRef onTriggerExit = component["OnTriggerExit"];
-        
-        if (onTriggerExit.isFunction()) {
-            try {
-                onTriggerExit(component, collision);
-            } catch (const luabridge::LuaException& e) {
-                std::cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << std::endl;
+        for (size_t i = 0; i < count; i++){
+            if (batched && events[i].kind == ContactEvent::CollisionEnter){
+                continue;
             }
-        }
-    }
-}
-
-
-void Actor::onCollisionEnter(Collision collision){
-    vector<string> keys;
-    for (const auto& [key, _] : components) {
-        keys.push_back(key);
-    }
-    std::sort(keys.begin(), keys.end());
-    
-    for(const auto& key : keys){
-        luabridge::LuaRef component = *(components[key]);
-        luabridge::LuaRef enabled = component["enabled"];
-        
-        if(!enabled){
-            continue;
-        }
-                
-        luabridge::LuaRef onCollisionEnter = component["OnCollisionEnter"];
-        if(onCollisionEnter.isFunction()){
-            try{
-                onCollisionEnter(component, collision);
-            }catch (const luabridge::LuaException& e) {
-                std::cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << std::endl;
+            
+            // Re-read every time, an earlier callback may have destroyed this actor
+            luabridge::LuaRef enabled = component["enabled"];
+            if(!enabled){
+                break;
+            }
+            
+            // Worker states can't share the pooled userdata, they get their own copy
+            if (component.state() == Component::lua_state){
+                Component::dispatch(component, callback_names[events[i].kind], name, *events[i].view);
+            } else {
+                Component::dispatch(component, callback_names[events[i].kind], name, events[i].collision);
             }
         }
-    }
-}
-
-void Actor::onCollisionExit(Collision collision){
-    vector<std::string> keys;
-    for (const auto& [key, _] : components) {
-        keys.push_back(key);
-    }
-    std::sort(keys.begin(), keys.end());
-    
-    for (const auto& key : keys) {
-        luabridge::LuaRef component = *(components[key]);
-        luabridge::LuaRef enabled = component["enabled"];
-        
-        if(!enabled){
-            continue;
-        }
-        
-        luabridge::LuaRef onCollisionExit = component["OnCollisionExit"];
         
-        if (onCollisionExit.isFunction()) {
-            try {
-                onCollisionExit(component, collision);
-            } catch (const luabridge::LuaException& e) {
-                std::cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << std::endl;
+        if (batched){
+            luabridge::LuaRef enabled = component["enabled"];
+            if(!enabled){
+                continue;
+            }
+            
+            bool pooled = component.state() == Component::lua_state;
+            luabridge::LuaRef list = pooled ? PhysicsPool::list() : luabridge::newTable(component.state());
+            int index = 1;
+            for (size_t i = 0; i < count; i++){
+                if (events[i].kind != ContactEvent::CollisionEnter){
+                    continue;
+                }
+                if (pooled){
+                    list[index++] = *events[i].view;
+                } else {
+                    list[index++] = events[i].collision;
+                }
+            }
+            if (pooled){
+                PhysicsPool::finishList(list, index - 1);
             }
+            Component::dispatch(component, "OnCollisionsEnter", name, list);
         }
     }
 }
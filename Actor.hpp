@@ -13,10 +13,17 @@
 class Actor {
 public:
     std::string name = "";
+    std::string template_name = "";
     int id;
     
     bool dont_destroy = false;
     
+    // Index of the script worker owning this actor's parallel-safe components, -1 when none
+    int script_worker = -1;
+    
+    // First Rigidbody component, lets worker states reach the body without the main Lua state
+    Rigidbody* rigidbody = nullptr;
+    
     std::map<std::string, std::shared_ptr<luabridge::LuaRef>> components;
 
     std::map<std::string, std::shared_ptr<luabridge::LuaRef>> to_add_components;
@@ -33,6 +40,9 @@ public:
     luabridge::LuaRef GetComponent(const std::string& type);
     luabridge::LuaRef GetComponents(const std::string& type);
     
+    // GetComponent for script worker states, only sees components living in L plus the Rigidbody
+    int GetComponentLocal(lua_State* L);
+    
     luabridge::LuaRef AddComponent(std::string type_name);
     void RemoveComponent(luabridge::LuaRef component_ref);
     
@@ -41,13 +51,14 @@ public:
     
     void injectConvenienceRef(std::shared_ptr<luabridge::LuaRef> component_ref){
         (*component_ref)["actor"] = this;
+        
+        if (rigidbody == nullptr && component_ref->isInstance<Rigidbody>()){
+            rigidbody = component_ref->cast<Rigidbody*>();
+        }
     }
     
-    void onTriggerEnter(Collision collision);
-    void onTriggerExit(Collision collision);
-    
-    void onCollisionEnter(Collision collision);
-    void onCollisionExit(Collision collision);
+    // Runs this step's contacts through every component in one pass, OnCollisionsEnter gets the enters as one list
+    void deliverContacts(const ContactEvent* events, size_t count);
     
     
     Actor(){};
@@ -59,8 +70,13 @@ public:
     static void readTemplates();
     static Actor GetTemplated(std::string templateName);
     
+    static void preloadTemplates(const rapidjson::Value& template_list);
+    
 private:
+    static void loadTemplate(const std::string& templateName);
+    
     static inline std::unordered_map<std::string, Actor> loadedTemplates;
+    static inline std::unordered_map<std::string, std::string> templatePaths;
     
 };
 
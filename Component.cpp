@@ -10,13 +10,21 @@
 #include "Scene.hpp"
 #include "Engine.hpp"
 #include "Rigidbody.hpp"
+#include "FastBindings.hpp"
+#include "ScriptWorkers.hpp"
+#include "StaticLayer.hpp"
+#include "Tilemap.hpp"
+#include <algorithm>
+#include <cctype>
 
 using namespace std;
 
 unordered_map<std::string, std::shared_ptr<luabridge::LuaRef>> Component::component_tables;
+unordered_map<std::string, filesystem::path> Component::component_paths;
 lua_State* Component::lua_state = nullptr;
 
 string Component::componentPath = "resources/component_types";
+string Component::componentCachePath = "resources/.cache/component_types";
 
 void Component::initialize(){
     
@@ -38,6 +46,57 @@ void Component::initializeState(){
 }
 
 
+int Component::messageHandler(lua_State* L){
+    const char* message = lua_tostring(L, 1);
+    if (message == nullptr){
+        message = luaL_tolstring(L, 1, nullptr);
+    }
+    
+    lua_pushfstring(L, "%s : %s", current_actor_name, message);
+    luaL_traceback(L, L, lua_tostring(L, -1), 1);
+    return 1;
+}
+
+
+void Component::protectedCall(lua_State* L, int handler_index, int arg_count, const std::string& actor_name){
+    // Dispatch can nest (Event.Publish inside OnUpdate), so restore the outer name afterwards
+    const char* outer_actor_name = current_actor_name;
+    current_actor_name = actor_name.c_str();
+    
+    if (lua_pcall(L, arg_count, 0, handler_index) != LUA_OK){
+        error_buffer.emplace_back(lua_tostring(L, -1));
+    }
+    
+    current_actor_name = outer_actor_name;
+    lua_settop(L, handler_index - 1);
+}
+
+
+void Component::flushErrors(){
+    for (const auto& error : error_buffer){
+        cout << "\033[31m" << error << "\033[0m" << endl;
+    }
+    error_buffer.clear();
+}
+
+
+void Component::takeErrors(std::vector<std::string>& out){
+    out.insert(out.end(), error_buffer.begin(), error_buffer.end());
+    error_buffer.clear();
+}
+
+
+void Component::reportError(const std::string& error){
+    error_buffer.push_back(error);
+}
+
+
+void Component::reportErrors(std::vector<std::string>& errors){
+    error_buffer.insert(error_buffer.end(), errors.begin(), errors.end());
+    errors.clear();
+}
+
+
 void Component::initializeFunctions(){
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Debug")
@@ -69,29 +128,31 @@ void Component::initializeFunctions(){
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Application")
         .addFunction("Quit", &Component::Quit)
-        .addFunction("GetFrame", &Component::GetFrame)
+        .addFunction("GetFrame", &FastBindings::ApplicationGetFrame)
         .addFunction("Sleep", &Component::Sleep)
         .addFunction("OpenURL", &Component::OpenURL)
+        .addFunction("DumpProfile", &ScriptProfiler::LuaDumpProfile)
         .endNamespace();
     
     
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Input")
-        .addFunction("GetKey", &Input::GetKey)
-        .addFunction("GetKeyDown", &Input::GetKeyDown)
-        .addFunction("GetKeyUp", &Input::GetKeyUp)
+        .addFunction("Key", &FastBindings::InputKey)
+        .addFunction("GetKey", &FastBindings::InputGetKey)
+        .addFunction("GetKeyDown", &FastBindings::InputGetKeyDown)
+        .addFunction("GetKeyUp", &FastBindings::InputGetKeyUp)
         .addFunction("GetMousePosition", &Component::InputGetMousePosition)
-        .addFunction("GetMouseButton", &Input::GetMouseButton)
-        .addFunction("GetMouseButtonDown", &Input::GetMouseButtonDown)
-        .addFunction("GetMouseButtonUp", &Input::GetMouseButtonUp)
-        .addFunction("GetMouseScrollDelta", &Input::GetMouseScrollDelta)
+        .addFunction("GetMouseButton", &FastBindings::InputGetMouseButton)
+        .addFunction("GetMouseButtonDown", &FastBindings::InputGetMouseButtonDown)
+        .addFunction("GetMouseButtonUp", &FastBindings::InputGetMouseButtonUp)
+        .addFunction("GetMouseScrollDelta", &FastBindings::InputGetMouseScrollDelta)
         .addFunction("HideCursor", &Input::HideCursor)
         .addFunction("ShowCursor", &Input::ShowCursor)
         .endNamespace();
     
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Text")
-        .addFunction("Draw", &Renderer::DrawText)
+        .addFunction("Draw", &FastBindings::TextDraw)
         .endNamespace();
     
     
@@ -105,21 +166,29 @@ void Component::initializeFunctions(){
     
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Image")
-        .addFunction("DrawUI", &Renderer::DrawUI)
-        .addFunction("DrawUIEx", &Renderer::DrawUIEx)
-        .addFunction("Draw", &Renderer::Draw)
-        .addFunction("DrawEx", &Renderer::DrawEx)
-        .addFunction("DrawPixel", &Renderer::DrawPixel)
+        .addFunction("DrawUI", &FastBindings::ImageDrawUI)
+        .addFunction("DrawUIEx", &FastBindings::ImageDrawUIEx)
+        .addFunction("Draw", &FastBindings::ImageDraw)
+        .addFunction("DrawEx", &FastBindings::ImageDrawEx)
+        .addFunction("DrawPixel", &FastBindings::ImageDrawPixel)
+        .addFunction("SetPixelMode", &Renderer::SetPixelMode)
+        .addFunction("Handle", &ImageDB::LuaHandle)
+        .addFunction("GetStats", &Renderer::LuaGetStats)
+        .addFunction("GetAtlasReport", &TextureAtlas::LuaGetReport)
+        .addFunction("AddStatic", &StaticLayer::LuaAdd)
+        .addFunction("UpdateStatic", &StaticLayer::LuaUpdate)
+        .addFunction("RemoveStatic", &StaticLayer::LuaRemove)
+        .addFunction("GetStaticEpoch", &StaticLayer::LuaGetEpoch)
         .endNamespace();
     
     
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Camera")
-        .addFunction("SetPosition", &Renderer::SetPosition)
-        .addFunction("GetPositionX", &Renderer::GetPositionX)
-        .addFunction("GetPositionY", &Renderer::GetPositionY)
-        .addFunction("SetZoom", &Renderer::SetZoom)
-        .addFunction("GetZoom", &Renderer::GetZoom)
+        .addFunction("SetPosition", &FastBindings::CameraSetPosition)
+        .addFunction("GetPositionX", &FastBindings::CameraGetPositionX)
+        .addFunction("GetPositionY", &FastBindings::CameraGetPositionY)
+        .addFunction("SetZoom", &FastBindings::CameraSetZoom)
+        .addFunction("GetZoom", &FastBindings::CameraGetZoom)
         .endNamespace();
     
     
@@ -131,49 +200,32 @@ void Component::initializeFunctions(){
         .endNamespace();
     
     
-    luabridge::getGlobalNamespace(lua_state)
-        .beginClass<b2Vec2>("Vector2")
-        .addConstructor<void(*)(float, float)>()
-        .addProperty("x", &b2Vec2::x)
-        .addProperty("y", &b2Vec2::y)
-        .addFunction("Normalize", &b2Vec2::Normalize)
-        .addFunction("Length", &b2Vec2::Length)
-        .addFunction("__add", &b2Vec2::operator_add)
-        .addFunction("__sub", &b2Vec2::operator_sub)
-        .addFunction("__mul", &b2Vec2::operator_mul)
-        .addStaticFunction("Distance", static_cast<float(*)(const b2Vec2&, const b2Vec2&)>(&b2Distance))
-        .addStaticFunction("Dot", static_cast<float(*)(const b2Vec2&, const b2Vec2&)>(&b2Dot))
-        .endClass();
-
-    
-    luabridge::getGlobalNamespace(lua_state)
-        .beginClass<Collision>("Collision")
-        .addData("other", &Collision::other)
-        .addData("point", &Collision::point)
-        .addData("relative_velocity", &Collision::relative_velocity)
-        .addData("normal", &Collision::normal)
-        .endClass();
+    initializeSharedFunctions(lua_state);
     
     
     luabridge::getGlobalNamespace(lua_state)
         .beginClass<HitResult>("HitResult")
-        .addData("actor", &HitResult::actor)
-        .addData("point", &HitResult::point)
-        .addData("normal", &HitResult::normal)
-        .addData("is_trigger", &HitResult::is_trigger)
+        .addProperty("actor", &HitResult::GetActor)
+        .addProperty("point", &HitResult::GetPoint)
+        .addProperty("normal", &HitResult::GetNormal)
+        .addProperty("is_trigger", &HitResult::GetIsTrigger)
         .endClass();
 
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Physics")
         .addFunction("Raycast", &RigidbodyManager::Raycast)
         .addFunction("RaycastAll", &RigidbodyManager::RaycastAll)
+        .addFunction("GetPositions", &RigidbodyManager::GetPositions)
+        .addFunction("GetVelocities", &RigidbodyManager::GetVelocities)
+        .addFunction("SetVelocities", &RigidbodyManager::SetVelocities)
         .endNamespace();
     
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Event")
-        .addFunction("Publish", &EventBus::Publish)
-        .addFunction("Subscribe", &EventBus::Subscribe)
-        .addFunction("Unsubscribe", &EventBus::Unsubscribe)
+        .addFunction("Publish", &EventBus::LuaPublish)
+        .addFunction("Subscribe", &EventBus::LuaSubscribe)
+        .addFunction("Unsubscribe", &EventBus::LuaUnsubscribe)
+        .addFunction("Id", &StringTable::LuaIntern)
         .endNamespace();
     
     luabridge::getGlobalNamespace(lua_state)
@@ -204,13 +256,16 @@ void Component::initializeFunctions(){
         .addData("trigger_width", &Rigidbody::trigger_width)
         .addData("trigger_height", &Rigidbody::trigger_height)
         .addData("trigger_radius", &Rigidbody::trigger_radius)
-        .addFunction("GetPosition", &Rigidbody::GetPosition)
+        .addFunction("GetPosition", &Rigidbody::LuaGetPosition)
         .addFunction("GetRotation", &Rigidbody::GetRotation)
         .addFunction("GetVelocity", &Rigidbody::GetVelocity)
         .addFunction("GetAngularVelocity", &Rigidbody::GetAngularVelocity)
         .addFunction("GetGravityScale", &Rigidbody::GetGravityScale)
         .addFunction("GetUpDirection", &Rigidbody::GetUpDirection)
         .addFunction("GetRightDirection", &Rigidbody::GetRightDirection)
+        .addFunction("GetPositionXY", &Rigidbody::GetPositionXY)
+        .addFunction("GetVelocityXY", &Rigidbody::GetVelocityXY)
+        .addFunction("SetVelocityXY", &Rigidbody::SetVelocityXY)
         .addFunction("AddForce", &Rigidbody::AddForce)
         .addFunction("SetVelocity", &Rigidbody::SetVelocity)
         .addFunction("SetPosition", &Rigidbody::SetPosition)
@@ -271,6 +326,33 @@ void Component::initializeFunctions(){
         .addFunction("Burst", &ParticleSystem::Burst)
         .endClass();
     
+    
+    luabridge::getGlobalNamespace(lua_state)
+        .beginClass<Tilemap>("Tilemap")
+        .addConstructor<void(*) (void)>()
+        .addData("x", &Tilemap::x)
+        .addData("y", &Tilemap::y)
+        .addData("enabled", &Tilemap::enabled)
+        .addData("key", &Tilemap::key)
+        .addData("type", &Tilemap::type)
+        .addData("actor", &Tilemap::actor)
+        .addData("onStart_called", &Tilemap::onStart_called)
+        .addData("tile_size", &Tilemap::tile_size)
+        .addData("sorting_order", &Tilemap::sorting_order)
+        .addData("map", &Tilemap::map)
+        .addData("has_collider", &Tilemap::has_collider)
+        .addData("collider_friction", &Tilemap::collider_friction)
+        .addData("collider_bounciness", &Tilemap::collider_bounciness)
+        .addFunction("SetTiles", &Tilemap::SetTiles)
+        .addFunction("SetTileImage", &Tilemap::SetTileImage)
+        .addFunction("SetSolid", &Tilemap::SetSolid)
+        .addFunction("GetTile", &Tilemap::GetTile)
+        .addFunction("SetTile", &Tilemap::SetTile)
+        .addFunction("GetWidth", &Tilemap::GetWidth)
+        .addFunction("GetHeight", &Tilemap::GetHeight)
+        .addFunction("GetLoopCount", &Tilemap::GetLoopCount)
+        .endClass();
+    
     luabridge::getGlobalNamespace(lua_state)
         .beginNamespace("Input")
         .addFunction("GetButton", static_cast<bool(*)(int, std::string)>(&Input::GetButton))
@@ -287,28 +369,220 @@ void Component::initializeFunctions(){
 }
 
 
-void Component::initializeComponents(){
+// Value types every Lua state needs, the main state and the script worker states alike
+void Component::initializeSharedFunctions(lua_State* L){
+    luabridge::getGlobalNamespace(L)
+        .beginClass<b2Vec2>("Vector2")
+        .addConstructor<void(*)(float, float)>()
+        .addProperty("x", &b2Vec2::x)
+        .addProperty("y", &b2Vec2::y)
+        .addFunction("Normalize", &b2Vec2::Normalize)
+        .addFunction("Length", &b2Vec2::Length)
+        .addFunction("__add", &b2Vec2::operator_add)
+        .addFunction("__sub", &b2Vec2::operator_sub)
+        .addFunction("__mul", &b2Vec2::operator_mul)
+        .addFunction("Set", &b2Vec2::Set)
+        .addFunction("AddInPlace", &b2Vec2::AddInPlace)
+        .addFunction("ScaleInPlace", &b2Vec2::ScaleInPlace)
+        .addStaticFunction("Distance", static_cast<float(*)(const b2Vec2&, const b2Vec2&)>(&b2Distance))
+        .addStaticFunction("Dot", static_cast<float(*)(const b2Vec2&, const b2Vec2&)>(&b2Dot))
+        .endClass();
     
+    luabridge::getGlobalNamespace(L)
+        .beginClass<Collision>("Collision")
+        .addProperty("other", &Collision::GetOther)
+        .addProperty("point", &Collision::GetPoint)
+        .addProperty("relative_velocity", &Collision::GetRelativeVelocity)
+        .addProperty("normal", &Collision::GetNormal)
+        .endClass();
+}
+
+
+void Component::initializeComponents(){
+    // Only index the scripts here, each type is executed the first time it is referenced
     for(const auto& entry : filesystem::directory_iterator(componentPath)){
-        int status = luaL_dofile(lua_state, entry.path().string().c_str());
-        if (status != LUA_OK){
-            cout << "problem with lua file " << entry.path().stem().string();
-            exit(0);
+        component_paths[entry.path().stem().string()] = entry.path();
+    }
+}
+
+
+void Component::loadComponentType(const std::string& type){
+    if(component_tables.find(type) != component_tables.end()){
+        return;
+    }
+    
+    auto path = component_paths.find(type);
+    if(path == component_paths.end()){
+        cout << "error: failed to locate component " << type;
+        exit(0);
+    }
+    
+    if (!loadComponentScript(lua_state, path->second)){
+        cout << "problem with lua file " << type;
+        exit(0);
+    }
+    
+    component_tables.insert({type, make_shared<luabridge::LuaRef>(luabridge::getGlobal(lua_state, type.c_str()))
+    });
+    
+    if (hot_reload){
+        error_code ec;
+        component_mtimes[type] = filesystem::last_write_time(path->second, ec);
+    }
+}
+
+
+// Polled rather than file-watched, inotify doesn't exist on macOS and a few stat calls
+// every half second are negligible. Runs between frames, so every live instance sees the
+// new functions from the next frame on.
+void Component::checkForReloads(){
+    if (!hot_reload || Helper::GetFrameNumber() % 30 != 0){
+        return;
+    }
+    
+    for (auto& [type, mtime] : component_mtimes){
+        error_code ec;
+        auto current = filesystem::last_write_time(component_paths[type], ec);
+        if (ec || current == mtime){
+            continue;
         }
+        mtime = current;
         
-        string componentName = entry.path().stem().string();
-        component_tables.insert({componentName, make_shared<luabridge::LuaRef>(luabridge::getGlobal(lua_state, componentName.c_str()))
-        });
+        if (reloadComponentType(lua_state, *component_tables[type], type)){
+            ScriptWorkers::reloadComponentType(type);
+            cout << "reloaded component " << type << endl;
+        }
+    }
+}
+
+
+// Re-runs the script and copies the fresh type table's fields into the existing one.
+// Instances reach the type through their metatable chain, so keeping the table's identity
+// keeps every instance's own data while functions and untouched defaults update in place.
+// Fields deleted from the script keep their old value.
+bool Component::reloadComponentType(lua_State* L, luabridge::LuaRef& type_table, const std::string& type){
+    int top = lua_gettop(L);
+    bool loaded = loadComponentScript(L, component_paths[type]);
+    
+    luabridge::LuaRef fresh = luabridge::getGlobal(L, type.c_str());
+    if (!loaded || !fresh.isTable() || fresh == type_table){
+        if (lua_gettop(L) > top && lua_isstring(L, -1)){
+            reportError("problem reloading lua file " + type + " : " + lua_tostring(L, -1));
+        }
+        lua_settop(L, top);
+        luabridge::setGlobal(L, type_table, type.c_str());
+        return false;
+    }
+    
+    type_table.push(L);
+    fresh.push(L);
+    lua_pushnil(L);
+    while (lua_next(L, -2)){
+        lua_pushvalue(L, -2);
+        lua_insert(L, -2);
+        lua_rawset(L, -5);
+    }
+    lua_settop(L, top);
+    
+    luabridge::setGlobal(L, type_table, type.c_str());
+    return true;
+}
+
+
+void Component::preloadComponentTypes(const rapidjson::Value& type_list){
+    for(const auto& type : type_list.GetArray()){
+        if(type.IsString()){
+            loadComponentType(type.GetString());
+        }
     }
 }
 
 
+// Executes a component script, preferring precompiled bytecode from the cache.
+// Cache entries are named <stem>-<content hash>.luac, so editing a script simply
+// produces a new entry and the stale one is removed on the next compile.
+bool Component::loadComponentScript(lua_State* L, const filesystem::path& script_path){
+    ifstream source_file(script_path, ios::binary);
+    if (!source_file){
+        return false;
+    }
+    string source((istreambuf_iterator<char>(source_file)), istreambuf_iterator<char>());
+    
+    string chunk_name = "@" + script_path.string();
+    string stem = script_path.stem().string();
+    
+    stringstream cache_name;
+    cache_name << stem << "-" << hex << setw(16) << setfill('0') << hashContents(source) << ".luac";
+    filesystem::path cache_file = filesystem::path(componentCachePath) / cache_name.str();
+    
+    error_code ec;
+    if (filesystem::exists(cache_file, ec)){
+        ifstream cached(cache_file, ios::binary);
+        string bytecode((istreambuf_iterator<char>(cached)), istreambuf_iterator<char>());
+        
+        if (luaL_loadbufferx(L, bytecode.data(), bytecode.size(), chunk_name.c_str(), "b") == LUA_OK){
+            return lua_pcall(L, 0, 0, 0) == LUA_OK;
+        }
+        // Bytecode from another Lua build or a truncated write, fall back to source
+        lua_pop(L, 1);
+    }
+    
+    if (luaL_loadbufferx(L, source.data(), source.size(), chunk_name.c_str(), "t") != LUA_OK){
+        return false;
+    }
+    
+    string bytecode;
+    lua_dump(L, [](lua_State*, const void* p, size_t sz, void* ud) -> int {
+        static_cast<string*>(ud)->append(static_cast<const char*>(p), sz);
+        return 0;
+    }, &bytecode, 0);
+    
+    filesystem::create_directories(componentCachePath, ec);
+    if (!ec){
+        for (const auto& old_entry : filesystem::directory_iterator(componentCachePath, ec)){
+            // Exactly <stem>-<16 hex digits>.luac, so Foo never prunes Foo-Bar's entries
+            string old_name = old_entry.path().filename().string();
+            size_t hash_start = stem.size() + 1;
+            bool is_stale_entry = old_name.size() == hash_start + 16 + 5
+                && old_name.compare(0, hash_start, stem + "-") == 0
+                && old_name.compare(hash_start + 16, 5, ".luac") == 0
+                && all_of(old_name.begin() + hash_start, old_name.begin() + hash_start + 16, [](char c){ return isxdigit(static_cast<unsigned char>(c)) != 0; });
+            if (is_stale_entry){
+                filesystem::remove(old_entry.path(), ec);
+            }
+        }
+        
+        filesystem::path temp_file = cache_file;
+        temp_file += ".tmp";
+        {
+            ofstream out(temp_file, ios::binary | ios::trunc);
+            out.write(bytecode.data(), static_cast<streamsize>(bytecode.size()));
+        }
+        filesystem::rename(temp_file, cache_file, ec);
+    }
+    
+    return lua_pcall(L, 0, 0, 0) == LUA_OK;
+}
+
+
+uint64_t Component::hashContents(const string& contents){
+    // FNV-1a, salted with the Lua version so bytecode never crosses interpreter builds
+    uint64_t hash = 14695981039346656037ull ^ static_cast<uint64_t>(LUA_VERSION_NUM);
+    for (unsigned char c : contents){
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+
 void Component::print(const string &message){
     cout << message << endl;
 }
 
 
 void Component::printError(const std::string &message){
+    flushErrors();
     cout << "Error: " << message << endl;
     exit(0);
 }
@@ -344,13 +618,20 @@ std::shared_ptr<luabridge::LuaRef> Component::applyComponent(const std::string&
         componentRef["enabled"] = true;
         componentRef["onStart_called"] = false;
         
+        return make_shared<luabridge::LuaRef>(componentRef);
+    }else if(type == "Tilemap"){
+        Tilemap* tilemap = new Tilemap();
+        luabridge::LuaRef componentRef(lua_state, tilemap);
+
+        componentRef["key"] = key;
+        componentRef["type"] = type;
+        componentRef["enabled"] = true;
+        componentRef["onStart_called"] = false;
+        
         return make_shared<luabridge::LuaRef>(componentRef);
     }
     
-    if(component_tables.find(type) == component_tables.end()){
-        cout << "error: failed to locate component " << type;
-        exit(0);
-    }
+    loadComponentType(type);
     
     luabridge::LuaRef instance = luabridge::newTable(lua_state);
     establishInheritance(instance, *component_tables[type]);
@@ -388,7 +669,7 @@ void Component::applyOverrides(const std::shared_ptr<luabridge::LuaRef>& compone
 }
 
 
-void Component::callOnStart(const std::shared_ptr<luabridge::LuaRef>& component, const string name) {
+void Component::callOnStart(const std::shared_ptr<luabridge::LuaRef>& component, const string& name) {
     
     luabridge::LuaRef enabled = (*component)["enabled"];
     if(!enabled.isBool() || !enabled.cast<bool>()){
@@ -409,21 +690,28 @@ void Component::callOnStart(const std::shared_ptr<luabridge::LuaRef>& component,
         ParticleSystem* ps = (*component).cast<ParticleSystem*>();
         ps->OnStart();
         return;
+    }else if ((*component).isInstance<Tilemap>()) {
+        Tilemap* tilemap = (*component).cast<Tilemap*>();
+        tilemap->OnStart();
+        return;
     }
     
-    luabridge::LuaRef onStart = (*component)["OnStart"];
-    if(onStart.isFunction()){
-        try{
-            onStart(*component);
-        }
-        catch (luabridge::LuaException e){
-            cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << endl;
-        }
-    }
+    dispatch(*component, "OnStart", name);
 }
 
 
-void Component::callOnUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const string name) {
+void Component::callOnUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const string& name) {
+    if (ScriptBudget::frameAborted()) {
+        return;
+    }
+    
+    // Checks enabled itself, it has to take its static sprites down when disabled
+    if ((*component).isInstance<Tilemap>()) {
+        Tilemap* tilemap = (*component).cast<Tilemap*>();
+        tilemap->OnUpdate();
+        return;
+    }
+    
     luabridge::LuaRef enabled = (*component)["enabled"];
     if(!enabled.isBool() || !enabled.cast<bool>()){
         return;
@@ -435,35 +723,23 @@ void Component::callOnUpdate(const std::shared_ptr<luabridge::LuaRef>& component
         return;
     }
     
-    luabridge::LuaRef onUpdate = (*component)["OnUpdate"];
-    if(onUpdate.isFunction()){
-        try{
-            onUpdate(*component);
-        }
-        catch (luabridge::LuaException e){
-            cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << endl;
-        }
-    }
+    dispatch(*component, "OnUpdate", name);
 }
 
 
-void Component::callOnLateUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const string name) {
+void Component::callOnLateUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const string& name) {
+    if (ScriptBudget::frameAborted()) {
+        return;
+    }
+    
     luabridge::LuaRef enabled = (*component)["enabled"];
     if(!enabled.isBool() || !enabled.cast<bool>()){
         return;
     }
-    luabridge::LuaRef onLateUpdate = (*component)["OnLateUpdate"];
-    if(onLateUpdate.isFunction()){
-        try{
-            onLateUpdate(*component);
-        }
-        catch (luabridge::LuaException e){
-            cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << endl;
-        }
-    }
+    dispatch(*component, "OnLateUpdate", name);
 }
 
-void Component::callOnDestroy(const std::shared_ptr<luabridge::LuaRef>& component, const string name) {
+void Component::callOnDestroy(const std::shared_ptr<luabridge::LuaRef>& component, const string& name) {
     if ((*component).isInstance<Rigidbody>()) {
         Rigidbody* rb = (*component).cast<Rigidbody*>();
         rb->OnDestroy();
@@ -472,17 +748,14 @@ void Component::callOnDestroy(const std::shared_ptr<luabridge::LuaRef>& componen
         ParticleSystem* ps = (*component).cast<ParticleSystem*>();
         ps->OnDestroy();
         return;
+    }else if ((*component).isInstance<Tilemap>()) {
+        Tilemap* tilemap = (*component).cast<Tilemap*>();
+        tilemap->OnDestroy();
+        return;
     }
     
     // For Lua components
-    luabridge::LuaRef onDestroy = (*component)["OnDestroy"];
-    if (onDestroy.isFunction()) {
-        try {
-            onDestroy(*component);
-        } catch (luabridge::LuaException e) {
-            cout << "\033[31m" << name << " : " << e.what() << "\033[0m" << endl;
-        }
-    }
+    dispatch(*component, "OnDestroy", name);
 }
 
 
@@ -560,6 +833,21 @@ std::shared_ptr<luabridge::LuaRef> Component::cloneComponent(const std::shared_p
         newPs->end_color_b = ps->end_color_b;
         newPs->end_color_a = ps->end_color_a;
         
+        return newComponent;
+    }else if ((*original).isInstance<Tilemap>()) {
+        auto tilemap = (*original).cast<Tilemap*>();
+        auto newComponent = applyComponent("Tilemap", key);
+        
+        Tilemap* newTilemap = (*newComponent).cast<Tilemap*>();
+        newTilemap->x = tilemap->x;
+        newTilemap->y = tilemap->y;
+        newTilemap->tile_size = tilemap->tile_size;
+        newTilemap->sorting_order = tilemap->sorting_order;
+        newTilemap->map = tilemap->map;
+        newTilemap->has_collider = tilemap->has_collider;
+        newTilemap->collider_friction = tilemap->collider_friction;
+        newTilemap->collider_bounciness = tilemap->collider_bounciness;
+        
         return newComponent;
     }
 
@@ -601,6 +889,8 @@ std::shared_ptr<luabridge::LuaRef> Component::cloneComponent(const std::shared_p
 }
 
 void Component::Quit(){
+    flushErrors();
+    ScriptProfiler::dump();
     exit(0);
 }
 
@@ -610,11 +900,6 @@ void Component::Sleep(int milliseconds){
 }
 
 
-int Component::GetFrame(){
-    return Helper::GetFrameNumber();
-}
-
-
 void Component::OpenURL(const std::string &url){
 #ifdef _WIN32
     std::string command = "start " + url;
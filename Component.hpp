@@ -10,25 +10,35 @@
 
 #include "Rigidbody.hpp"
 #include "EventBus.hpp"
+#include "ScriptProfiler.hpp"
+#include "ScriptBudget.hpp"
 
 
 class Component{
 private:
     static std::string componentPath;
+    static std::string componentCachePath;
 
     static void initializeState();
     static void initializeFunctions();
     static void initializeComponents();
     
-    static void print(const std::string& message);
-    static void printError(const std::string& message);
+    static uint64_t hashContents(const std::string& contents);
+    
+    static inline std::unordered_map<std::string, std::filesystem::file_time_type> component_mtimes;
     
     static void Quit();
     static void Sleep(int milliseconds);
-    static int GetFrame();
     static void OpenURL(const std::string& url);
     
     static luabridge::LuaRef InputGetMousePosition();
+    
+    static int messageHandler(lua_State* L);
+    static void protectedCall(lua_State* L, int handler_index, int arg_count, const std::string& actor_name);
+    
+    // Per thread, script workers dispatch into their own Lua states concurrently
+    static inline thread_local const char* current_actor_name = "";
+    static inline thread_local std::vector<std::string> error_buffer;
 
 
 public:
@@ -37,8 +47,28 @@ public:
     
     static std::unordered_map<std::string, std::shared_ptr<luabridge::LuaRef>> component_tables;
     
+    static std::unordered_map<std::string, std::filesystem::path> component_paths;
+    
     static void initialize();
     
+    static void initializeSharedFunctions(lua_State* L);
+    
+    static bool loadComponentScript(lua_State* L, const std::filesystem::path& script_path);
+    
+    static void print(const std::string& message);
+    static void printError(const std::string& message);
+    
+    static void loadComponentType(const std::string& type);
+    
+    static void preloadComponentTypes(const rapidjson::Value& type_list);
+    
+    // Set from "hot_reload" in game.config, edited scripts are re-run and patched into live types
+    static inline bool hot_reload = false;
+    
+    static void checkForReloads();
+    
+    static bool reloadComponentType(lua_State* L, luabridge::LuaRef& type_table, const std::string& type);
+    
     static void establishInheritance(luabridge::LuaRef& instance, luabridge::LuaRef& parent);
     
     static std::shared_ptr<luabridge::LuaRef> applyComponent(const std::string& type, const std::string& key);
@@ -47,13 +77,68 @@ public:
     
     static std::shared_ptr<luabridge::LuaRef> cloneComponent(const std::shared_ptr<luabridge::LuaRef>& original, const std::string& key);
 
-    static void callOnStart(const std::shared_ptr<luabridge::LuaRef>& component, const std::string name);
+    static void callOnStart(const std::shared_ptr<luabridge::LuaRef>& component, const std::string& name);
+    
+    static void callOnUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const std::string& name);
+    
+    static void callOnLateUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const std::string& name);
+    
+    static void callOnDestroy(const std::shared_ptr<luabridge::LuaRef>& component, const std::string& name);
+    
+    // Calls component:function_name(args...) under lua_pcall, errors go to the error buffer. Lifecycle
+    // callbacks always go through, the per-frame callers skip an aborted frame themselves.
+    template<typename... Args>
+    static void dispatch(const luabridge::LuaRef& component, const char* function_name, const std::string& actor_name, const Args&... args){
+        lua_State* L = component.state();
+        int handler_index = lua_gettop(L) + 1;
+        lua_pushcfunction(L, &Component::messageHandler);
+        
+        component.push(L);
+        lua_getfield(L, -1, function_name);
+        if (!lua_isfunction(L, -1)){
+            lua_settop(L, handler_index - 1);
+            return;
+        }
+        lua_insert(L, -2);
+        
+        (luabridge::Stack<Args>::push(L, args), ...);
+        
+        bool profiled = ScriptProfiler::enabled && L == lua_state;
+        if (profiled){
+            ScriptProfiler::enter(component, function_name);
+        }
+        if (ScriptBudget::enabled){
+            ScriptBudget::enter(component, function_name, actor_name);
+        }
+        
+        protectedCall(L, handler_index, 1 + static_cast<int>(sizeof...(Args)), actor_name);
+        
+        if (ScriptBudget::enabled){
+            ScriptBudget::leave();
+        }
+        if (profiled){
+            ScriptProfiler::leave();
+        }
+    }
     
-    static void callOnUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const std::string name);
+    // Calls function(args...) under lua_pcall, errors go to the error buffer
+    template<typename... Args>
+    static void callFunction(const luabridge::LuaRef& function, const std::string& actor_name, const Args&... args){
+        lua_State* L = function.state();
+        int handler_index = lua_gettop(L) + 1;
+        lua_pushcfunction(L, &Component::messageHandler);
+        
+        function.push(L);
+        (luabridge::Stack<Args>::push(L, args), ...);
+        protectedCall(L, handler_index, static_cast<int>(sizeof...(Args)), actor_name);
+    }
     
-    static void callOnLateUpdate(const std::shared_ptr<luabridge::LuaRef>& component, const std::string name);
+    static void flushErrors();
     
-    static void callOnDestroy(const std::shared_ptr<luabridge::LuaRef>& component, const std::string name);
+    // Moves this thread's pending errors into / out of the error buffer
+    static void takeErrors(std::vector<std::string>& out);
+    static void reportErrors(std::vector<std::string>& errors);
+    static void reportError(const std::string& error);
 };
 
 
@@ -1,29 +1,33 @@
 // EventBus.cpp
 #include "EventBus.hpp"
 #include "Component.hpp"
+#include "ScriptWorkers.hpp"
 
 
-void EventBus::Publish(const std::string& event_type, luabridge::LuaRef event_object) {
-    if (subscriptions.find(event_type) == subscriptions.end()) {
+void EventBus::Publish(uint32_t event_type, luabridge::LuaRef event_object) {
+    auto found = subscriptions.find(event_type);
+    if (found == subscriptions.end()) {
         return; // No subscribers for this event type
     }
     
     // Call all subscriber functions for this event type
-    for (const auto& [component, function] : subscriptions[event_type]) {
-        try {
-            function(component, event_object);
-        } catch (const luabridge::LuaException& e) {
-            std::cout << "\033[31mEvent handling error: " << e.what() << "\033[0m" << std::endl;
+    for (const auto& [component, function] : found->second) {
+        // Subscribers living in a script worker's state get their own copy of the event
+        if (function.state() != event_object.state()) {
+            luabridge::LuaRef local_event = ScriptWorkers::transferRef(event_object, function.state());
+            Component::callFunction(function, "Event handling error", component, local_event);
+            continue;
         }
+        Component::callFunction(function, "Event handling error", component, event_object);
     }
 }
 
-void EventBus::Subscribe(const std::string& event_type, luabridge::LuaRef component, luabridge::LuaRef function) {
+void EventBus::Subscribe(uint32_t event_type, luabridge::LuaRef component, luabridge::LuaRef function) {
     // Queue subscription to be processed at end of frame
     pending_subscriptions.push_back(EventSubscription(event_type, component, function));
 }
 
-void EventBus::Unsubscribe(const std::string& event_type, luabridge::LuaRef component, luabridge::LuaRef function) {
+void EventBus::Unsubscribe(uint32_t event_type, luabridge::LuaRef component, luabridge::LuaRef function) {
     // Queue unsubscription to be processed at end of frame
     pending_unsubscriptions.push_back(EventSubscription(event_type, component, function));
 }
@@ -52,8 +56,9 @@ void EventBus::ProcessEvents() {
         for (auto it = subs.begin(); it != subs.end(); /* no increment */) {
             const auto& [sub_component, sub_function] = *it;
             
-            // Compare component and function references
-            if (unsub.component == sub_component && unsub.function == sub_function) {
+            // Compare component and function references, refs from different Lua states never match
+            if (unsub.function.state() == sub_function.state() &&
+                unsub.component == sub_component && unsub.function == sub_function) {
                 it = subs.erase(it);
             } else {
                 ++it;
@@ -67,3 +72,21 @@ void EventBus::ProcessEvents() {
     }
     pending_unsubscriptions.clear();
 }
+
+
+int EventBus::LuaPublish(lua_State* L) {
+    Publish(StringTable::FromLua(L, 1), luabridge::LuaRef::fromStack(L, 2));
+    return 0;
+}
+
+
+int EventBus::LuaSubscribe(lua_State* L) {
+    Subscribe(StringTable::FromLua(L, 1), luabridge::LuaRef::fromStack(L, 2), luabridge::LuaRef::fromStack(L, 3));
+    return 0;
+}
+
+
+int EventBus::LuaUnsubscribe(lua_State* L) {
+    Unsubscribe(StringTable::FromLua(L, 1), luabridge::LuaRef::fromStack(L, 2), luabridge::LuaRef::fromStack(L, 3));
+    return 0;
+}
@@ -8,32 +8,39 @@
 #include <utility>
 #include "lua/lua.hpp"
 #include "LuaBridge/LuaBridge.h"
+#include "StringTable.hpp"
 
+// Event types are StringTable ids
 struct EventSubscription {
-    std::string event_type;
+    uint32_t event_type;
     luabridge::LuaRef component;
     luabridge::LuaRef function;
     
-    EventSubscription(const std::string& type, luabridge::LuaRef comp, luabridge::LuaRef func)
+    EventSubscription(uint32_t type, luabridge::LuaRef comp, luabridge::LuaRef func)
         : event_type(type), component(comp), function(func) {}
 };
 
 class EventBus {
 public:
     
-    static void Publish(const std::string& event_type, luabridge::LuaRef event_object);
+    static void Publish(uint32_t event_type, luabridge::LuaRef event_object);
     
-    static void Subscribe(const std::string& event_type, luabridge::LuaRef component, luabridge::LuaRef function);
+    static void Subscribe(uint32_t event_type, luabridge::LuaRef component, luabridge::LuaRef function);
     
-    static void Unsubscribe(const std::string& event_type, luabridge::LuaRef component, luabridge::LuaRef function);
+    static void Unsubscribe(uint32_t event_type, luabridge::LuaRef component, luabridge::LuaRef function);
     
     static void ProcessEvents();
+    
+    // Lua entry points, the event type may be a name or an id from Event.Id
+    static int LuaPublish(lua_State* L);
+    static int LuaSubscribe(lua_State* L);
+    static int LuaUnsubscribe(lua_State* L);
 
 private:
     static inline std::vector<EventSubscription> pending_subscriptions;
     static inline std::vector<EventSubscription> pending_unsubscriptions;
     
-    static inline std::unordered_map<std::string, std::vector<std::pair<luabridge::LuaRef, luabridge::LuaRef>>> subscriptions;
+    static inline std::unordered_map<uint32_t, std::vector<std::pair<luabridge::LuaRef, luabridge::LuaRef>>> subscriptions;
 };
 
 #endif /* EventBus_hpp */
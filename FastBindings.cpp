@@ -0,0 +1,148 @@
+//
+//  FastBindings.cpp
+//  game_engine
+//
+//  Created by Stanley  on 4/20/25.
+//
+
+#include "FastBindings.hpp"
+#include "Renderer.hpp"
+
+using namespace std;
+
+
+int FastBindings::ImageDraw(lua_State* L){
+    Renderer::Draw(StringTable::FromLua(L, 1), number(L, 2), number(L, 3));
+    return 0;
+}
+
+
+int FastBindings::ImageDrawEx(lua_State* L){
+    Renderer::DrawEx(StringTable::FromLua(L, 1), number(L, 2), number(L, 3), number(L, 4),
+                     number(L, 5), number(L, 6), number(L, 7), number(L, 8),
+                     number(L, 9), number(L, 10), number(L, 11), number(L, 12), number(L, 13));
+    return 0;
+}
+
+
+int FastBindings::ImageDrawUI(lua_State* L){
+    Renderer::DrawUI(StringTable::FromLua(L, 1), number(L, 2), number(L, 3));
+    return 0;
+}
+
+
+int FastBindings::ImageDrawUIEx(lua_State* L){
+    Renderer::DrawUIEx(StringTable::FromLua(L, 1), number(L, 2), number(L, 3), number(L, 4),
+                       number(L, 5), number(L, 6), number(L, 7), number(L, 8));
+    return 0;
+}
+
+
+int FastBindings::ImageDrawPixel(lua_State* L){
+    Renderer::DrawPixel(number(L, 1), number(L, 2), number(L, 3), number(L, 4), number(L, 5), number(L, 6));
+    return 0;
+}
+
+
+int FastBindings::TextDraw(lua_State* L){
+    Renderer::DrawText(view(L, 1), number(L, 2), number(L, 3), StringTable::FromLua(L, 4), number(L, 5),
+                       number(L, 6), number(L, 7), number(L, 8), number(L, 9));
+    return 0;
+}
+
+
+SDL_Scancode FastBindings::scancode(lua_State* L, int index){
+    // lua_type rather than lua_isnumber, the key name "1" must not be read as a handle
+    if (lua_type(L, index) == LUA_TNUMBER){
+        lua_Integer handle = lua_tointeger(L, index);
+        if (handle <= 0 || handle >= SDL_NUM_SCANCODES){
+            return SDL_SCANCODE_UNKNOWN;
+        }
+        return static_cast<SDL_Scancode>(handle);
+    }
+    return Input::GetScancode(view(L, index));
+}
+
+
+int FastBindings::InputKey(lua_State* L){
+    lua_pushinteger(L, Input::GetScancode(view(L, 1)));
+    return 1;
+}
+
+
+int FastBindings::InputGetKey(lua_State* L){
+    lua_pushboolean(L, Input::GetKey(scancode(L, 1)));
+    return 1;
+}
+
+
+int FastBindings::InputGetKeyDown(lua_State* L){
+    lua_pushboolean(L, Input::GetKeyDown(scancode(L, 1)));
+    return 1;
+}
+
+
+int FastBindings::InputGetKeyUp(lua_State* L){
+    lua_pushboolean(L, Input::GetKeyUp(scancode(L, 1)));
+    return 1;
+}
+
+
+int FastBindings::InputGetMouseButton(lua_State* L){
+    lua_pushboolean(L, Input::GetMouseButton(static_cast<int>(lua_tointeger(L, 1))));
+    return 1;
+}
+
+
+int FastBindings::InputGetMouseButtonDown(lua_State* L){
+    lua_pushboolean(L, Input::GetMouseButtonDown(static_cast<int>(lua_tointeger(L, 1))));
+    return 1;
+}
+
+
+int FastBindings::InputGetMouseButtonUp(lua_State* L){
+    lua_pushboolean(L, Input::GetMouseButtonUp(static_cast<int>(lua_tointeger(L, 1))));
+    return 1;
+}
+
+
+int FastBindings::InputGetMouseScrollDelta(lua_State* L){
+    lua_pushnumber(L, Input::GetMouseScrollDelta());
+    return 1;
+}
+
+
+int FastBindings::CameraSetPosition(lua_State* L){
+    Renderer::SetPosition(number(L, 1), number(L, 2));
+    return 0;
+}
+
+
+int FastBindings::CameraGetPositionX(lua_State* L){
+    lua_pushnumber(L, Renderer::GetPositionX());
+    return 1;
+}
+
+
+int FastBindings::CameraGetPositionY(lua_State* L){
+    lua_pushnumber(L, Renderer::GetPositionY());
+    return 1;
+}
+
+
+int FastBindings::CameraSetZoom(lua_State* L){
+    Renderer::SetZoom(number(L, 1));
+    return 0;
+}
+
+
+int FastBindings::CameraGetZoom(lua_State* L){
+    lua_pushnumber(L, Renderer::GetZoom());
+    return 1;
+}
+
+
+int FastBindings::ApplicationGetFrame(lua_State* L){
+    lua_pushinteger(L, Helper::GetFrameNumber());
+    return 1;
+}
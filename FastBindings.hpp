@@ -0,0 +1,61 @@
+//
+//  FastBindings.hpp
+//  game_engine
+//
+//  Created by Stanley  on 4/20/25.
+//
+
+#ifndef FastBindings_hpp
+#define FastBindings_hpp
+
+#include <string_view>
+#include "lua/lua.hpp"
+#include "SDL/SDL.h"
+
+// Hand-written lua_CFunctions for the engine calls scripts make every frame.
+// They read arguments straight off the Lua stack (lua_tonumber / lua_tolstring views)
+// instead of going through LuaBridge's generic marshaling and std::string copies.
+class FastBindings{
+public:
+    static int ImageDraw(lua_State* L);
+    static int ImageDrawEx(lua_State* L);
+    static int ImageDrawUI(lua_State* L);
+    static int ImageDrawUIEx(lua_State* L);
+    static int ImageDrawPixel(lua_State* L);
+    
+    static int TextDraw(lua_State* L);
+    
+    static int InputKey(lua_State* L);
+    static int InputGetKey(lua_State* L);
+    static int InputGetKeyDown(lua_State* L);
+    static int InputGetKeyUp(lua_State* L);
+    static int InputGetMouseButton(lua_State* L);
+    static int InputGetMouseButtonDown(lua_State* L);
+    static int InputGetMouseButtonUp(lua_State* L);
+    static int InputGetMouseScrollDelta(lua_State* L);
+    
+    static int CameraSetPosition(lua_State* L);
+    static int CameraGetPositionX(lua_State* L);
+    static int CameraGetPositionY(lua_State* L);
+    static int CameraSetZoom(lua_State* L);
+    static int CameraGetZoom(lua_State* L);
+    
+    static int ApplicationGetFrame(lua_State* L);
+    
+private:
+    static float number(lua_State* L, int index){
+        return static_cast<float>(lua_tonumber(L, index));
+    }
+    
+    static std::string_view view(lua_State* L, int index){
+        size_t length = 0;
+        const char* str = lua_tolstring(L, index, &length);
+        return str ? std::string_view(str, length) : std::string_view();
+    }
+    
+    // Key handle from Input.Key, or a key name resolved on the spot
+    static SDL_Scancode scancode(lua_State* L, int index);
+};
+
+
+#endif /* FastBindings_hpp */
@@ -0,0 +1,95 @@
+//
+//  GlyphAtlas.cpp
+//  game_engine
+//
+//  Created by Stanley  on 5/2/25.
+//
+
+#include "GlyphAtlas.hpp"
+
+using namespace std;
+
+
+FontGlyphs& GlyphAtlas::forFont(TTF_Font* font, uint32_t font_id, int size){
+    uint64_t cache_key = (static_cast<uint64_t>(font_id) << 32) | static_cast<uint32_t>(size);
+    FontGlyphs& glyphs = fonts[cache_key];
+    glyphs.font = font;
+    return glyphs;
+}
+
+
+void GlyphAtlas::load(SDL_Renderer* renderer, FontGlyphs& font, unsigned char character){
+    Glyph& glyph = font.glyphs[character];
+    glyph.loaded = true;
+    
+    int min_x = 0, max_x = 0, min_y = 0, max_y = 0;
+    TTF_GlyphMetrics(font.font, character, &min_x, &max_x, &min_y, &max_y, &glyph.advance);
+    
+    SDL_Color white = {255, 255, 255, 255};
+    SDL_Surface* rendered = TTF_RenderGlyph_Solid(font.font, character, white);
+    if (!rendered){
+        return;
+    }
+    
+    // Blitting the colorkeyed solid glyph onto a zeroed ARGB surface leaves the background transparent
+    SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, rendered->w, rendered->h, 32, SDL_PIXELFORMAT_ARGB8888);
+    SDL_BlitSurface(rendered, nullptr, surface, nullptr);
+    SDL_FreeSurface(rendered);
+    
+    int padded_w = surface->w + 2;
+    int padded_h = surface->h + 2;
+    
+    SDL_Rect slot;
+    AtlasPage* target = nullptr;
+    for (AtlasPage& page : font.pages){
+        if (page.insert(padded_w, padded_h, slot)){
+            target = &page;
+            break;
+        }
+    }
+    if (!target && padded_w <= page_size && padded_h <= page_size){
+        AtlasPage page = TextureAtlas::createPage(renderer, page_size);
+        if (page.texture){
+            font.pages.push_back(page);
+            target = &font.pages.back();
+            target->insert(padded_w, padded_h, slot);
+        }
+    }
+    
+    if (target){
+        glyph.image.texture = target->texture;
+        glyph.image.src = {slot.x + 1, slot.y + 1, surface->w, surface->h};
+        glyph.image.texture_w = target->size;
+        glyph.image.texture_h = target->size;
+        glyph.image.in_atlas = true;
+        
+        SDL_LockSurface(surface);
+        SDL_UpdateTexture(target->texture, &glyph.image.src, surface->pixels, surface->pitch);
+        SDL_UnlockSurface(surface);
+    }
+    
+    SDL_FreeSurface(surface);
+}
+
+
+int GlyphAtlas::kerning(FontGlyphs& font, unsigned char previous, unsigned char character){
+    uint32_t pair = (static_cast<uint32_t>(previous) << 8) | character;
+    auto cached = font.kerning.find(pair);
+    if (cached != font.kerning.end()){
+        return cached->second;
+    }
+    
+    int amount = TTF_GetFontKerningSizeGlyphs(font.font, previous, character);
+    font.kerning[pair] = amount;
+    return amount;
+}
+
+
+void GlyphAtlas::clear(){
+    for (auto& [cache_key, font] : fonts){
+        for (AtlasPage& page : font.pages){
+            SDL_DestroyTexture(page.texture);
+        }
+    }
+    fonts.clear();
+}
@@ -0,0 +1,63 @@
+//
+//  GlyphAtlas.hpp
+//  game_engine
+//
+//  Created by Stanley  on 5/2/25.
+//
+
+#ifndef GlyphAtlas_hpp
+#define GlyphAtlas_hpp
+
+#include <array>
+#include <vector>
+#include <unordered_map>
+#include "SDL/SDL.h"
+#include "SDL_ttf/SDL_ttf.h"
+#include "TextureAtlas.hpp"
+
+struct Glyph {
+    ImageEntry image;
+    int advance = 0;
+    bool loaded = false;
+};
+
+
+// Glyphs of one (font, size), rasterized the first time each character is drawn
+struct FontGlyphs {
+    TTF_Font* font = nullptr;
+    std::array<Glyph, 256> glyphs{};
+    std::vector<AtlasPage> pages;
+    std::unordered_map<uint32_t, int> kerning;
+};
+
+
+// Text.Draw strings laid out from per-font glyph pages and drawn as quads through the sprite batch,
+// so text that changes every frame (timers, counters) needs no TTF rendering or texture creation.
+// Glyphs are rendered white with TTF_RenderGlyph_Solid, the text color comes from the vertex color.
+// Text is treated as Latin-1, like TTF_RenderText_Solid.
+class GlyphAtlas{
+public:
+    static inline int page_size = 512;
+    
+    static FontGlyphs& forFont(TTF_Font* font, uint32_t font_id, int size);
+    
+    static const Glyph& glyph(SDL_Renderer* renderer, FontGlyphs& font, unsigned char character){
+        Glyph& entry = font.glyphs[character];
+        if (!entry.loaded){
+            load(renderer, font, character);
+        }
+        return entry;
+    }
+    
+    static int kerning(FontGlyphs& font, unsigned char previous, unsigned char character);
+    
+    static void clear();
+    
+private:
+    // Keyed by (font id << 32 | size) like FontDB
+    static inline std::unordered_map<uint64_t, FontGlyphs> fonts;
+    
+    static void load(SDL_Renderer* renderer, FontGlyphs& font, unsigned char character);
+};
+
+#endif /* GlyphAtlas_hpp */
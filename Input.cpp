@@ -10,12 +10,8 @@
 #include <iostream>
 
 void Input::Init() {
-    keyboard_states.clear();
-    just_became_down_scancodes.clear();
-    just_became_up_scancodes.clear();
-    mouse_button_states.clear();
-    just_became_down_buttons.clear();
-    just_became_up_buttons.clear();
+    keyboard_states.fill(ButtonState());
+    mouse_button_states.fill(ButtonState());
     mouse_position = glm::vec2(0.0f, 0.0f);
     mouse_scroll_this_frame = 0.0f;
 
@@ -26,64 +22,70 @@ void Input::Init() {
     
     SDL_GameControllerEventState(SDL_ENABLE);
     
-    controllers.clear();
-    controller_button_states.clear();
-    just_became_down_controller_buttons.clear();
-    just_became_up_controller_buttons.clear();
-    controller_axis_values.clear();
+    controllers.fill(ControllerState());
     
     for (int i = 0; i < SDL_NumJoysticks(); i++) {
         if (SDL_IsGameController(i)) {
-            SDL_GameController* controller = SDL_GameControllerOpen(i);
-            if (controller) {
-                controllers[i] = controller;
-                std::cout << "Controller connected: " << SDL_GameControllerName(controller) << std::endl;
-                
-                controller_button_states[i] = std::unordered_map<SDL_GameControllerButton, INPUT_STATE>();
-                for (int b = 0; b < SDL_CONTROLLER_BUTTON_MAX; b++) {
-                    controller_button_states[i][static_cast<SDL_GameControllerButton>(b)] = INPUT_STATE_UP;
-                }
-                
-                controller_axis_values[i] = std::unordered_map<SDL_GameControllerAxis, float>();
-                for (int a = 0; a < SDL_CONTROLLER_AXIS_MAX; a++) {
-                    controller_axis_values[i][static_cast<SDL_GameControllerAxis>(a)] = 0.0f;
-                }
-                
-                just_became_down_controller_buttons[i] = std::vector<SDL_GameControllerButton>();
-                just_became_up_controller_buttons[i] = std::vector<SDL_GameControllerButton>();
-            }
+            openController(i);
         }
     }
 }
 
 void Input::Shutdown() {
     // Close all open controllers
-    for (auto& [id, controller] : controllers) {
-        if (controller) {
-            SDL_GameControllerClose(controller);
+    for (ControllerState& controller : controllers) {
+        if (controller.handle) {
+            SDL_GameControllerClose(controller.handle);
         }
+        controller = ControllerState();
     }
-    controllers.clear();
+}
+
+void Input::openController(int device_index) {
+    SDL_JoystickID instance_id = SDL_JoystickGetDeviceInstanceID(device_index);
+    if (controllerByInstance(instance_id)) {
+        return;
+    }
+    
+    // First free slot, scripts keep addressing a controller by the slot it was given
+    for (ControllerState& controller : controllers) {
+        if (controller.handle) {
+            continue;
+        }
+        
+        SDL_GameController* handle = SDL_GameControllerOpen(device_index);
+        if (handle) {
+            controller = ControllerState();
+            controller.handle = handle;
+            controller.instance_id = instance_id;
+            std::cout << "Controller connected: " << SDL_GameControllerName(handle) << std::endl;
+        }
+        return;
+    }
+}
+
+ControllerState* Input::controllerByInstance(SDL_JoystickID instance_id) {
+    for (ControllerState& controller : controllers) {
+        if (controller.handle && controller.instance_id == instance_id) {
+            return &controller;
+        }
+    }
+    return nullptr;
 }
 
 void Input::ProcessEvent(const SDL_Event& e) {
     switch (e.type) {
         // Keyboard events
+        // Unmapped keys arrive as SDL_SCANCODE_UNKNOWN, the slot unknown names and handles read
         case SDL_KEYDOWN: {
-            SDL_Scancode sc = e.key.keysym.scancode;
-            if (keyboard_states[sc] != INPUT_STATE_DOWN &&
-                keyboard_states[sc] != INPUT_STATE_JUST_BECAME_DOWN) {
-                keyboard_states[sc] = INPUT_STATE_JUST_BECAME_DOWN;
-                just_became_down_scancodes.push_back(sc);
+            if (e.key.keysym.scancode != SDL_SCANCODE_UNKNOWN) {
+                keyboard_states[e.key.keysym.scancode].press(frame);
             }
             break;
         }
         case SDL_KEYUP: {
-            SDL_Scancode sc = e.key.keysym.scancode;
-            if (keyboard_states[sc] != INPUT_STATE_UP &&
-                keyboard_states[sc] != INPUT_STATE_JUST_BECAME_UP) {
-                keyboard_states[sc] = INPUT_STATE_JUST_BECAME_UP;
-                just_became_up_scancodes.push_back(sc);
+            if (e.key.keysym.scancode != SDL_SCANCODE_UNKNOWN) {
+                keyboard_states[e.key.keysym.scancode].release(frame);
             }
             break;
         }
@@ -95,20 +97,14 @@ void Input::ProcessEvent(const SDL_Event& e) {
             break;
         }
         case SDL_MOUSEBUTTONDOWN: {
-            int button = e.button.button;
-            if (mouse_button_states[button] != INPUT_STATE_DOWN &&
-                mouse_button_states[button] != INPUT_STATE_JUST_BECAME_DOWN) {
-                mouse_button_states[button] = INPUT_STATE_JUST_BECAME_DOWN;
-                just_became_down_buttons.push_back(button);
+            if (e.button.button < MAX_MOUSE_BUTTONS) {
+                mouse_button_states[e.button.button].press(frame);
             }
             break;
         }
         case SDL_MOUSEBUTTONUP: {
-            int button = e.button.button;
-            if (mouse_button_states[button] != INPUT_STATE_UP &&
-                mouse_button_states[button] != INPUT_STATE_JUST_BECAME_UP) {
-                mouse_button_states[button] = INPUT_STATE_JUST_BECAME_UP;
-                just_became_up_buttons.push_back(button);
+            if (e.button.button < MAX_MOUSE_BUTTONS) {
+                mouse_button_states[e.button.button].release(frame);
             }
             break;
         }
@@ -117,47 +113,20 @@ void Input::ProcessEvent(const SDL_Event& e) {
             break;
         }
         
-        // Controller connection events
+        // Controller connection events, which is a device index here
         case SDL_CONTROLLERDEVICEADDED: {
-            int which = e.cdevice.which;
-            if (!SDL_IsGameController(which)) {
-                return;
-            }
-            
-            SDL_GameController* controller = SDL_GameControllerOpen(which);
-            if (controller) {
-                controllers[which] = controller;
-                std::cout << "Controller connected: " << SDL_GameControllerName(controller) << std::endl;
-                
-                // Initialize button states for this controller
-                controller_button_states[which] = std::unordered_map<SDL_GameControllerButton, INPUT_STATE>();
-                for (int b = 0; b < SDL_CONTROLLER_BUTTON_MAX; b++) {
-                    controller_button_states[which][static_cast<SDL_GameControllerButton>(b)] = INPUT_STATE_UP;
-                }
-                
-                // Initialize axis values for this controller
-                controller_axis_values[which] = std::unordered_map<SDL_GameControllerAxis, float>();
-                for (int a = 0; a < SDL_CONTROLLER_AXIS_MAX; a++) {
-                    controller_axis_values[which][static_cast<SDL_GameControllerAxis>(a)] = 0.0f;
-                }
-                
-                // Initialize vectors for tracking buttons that just changed state
-                just_became_down_controller_buttons[which] = std::vector<SDL_GameControllerButton>();
-                just_became_up_controller_buttons[which] = std::vector<SDL_GameControllerButton>();
+            if (SDL_IsGameController(e.cdevice.which)) {
+                openController(e.cdevice.which);
             }
             break;
         }
         
+        // From here on which is a joystick instance id
         case SDL_CONTROLLERDEVICEREMOVED: {
-            int which = e.cdevice.which;
-            auto it = controllers.find(which);
-            if (it != controllers.end()) {
-                SDL_GameControllerClose(it->second);
-                controllers.erase(it);
-                controller_button_states.erase(which);
-                just_became_down_controller_buttons.erase(which);
-                just_became_up_controller_buttons.erase(which);
-                controller_axis_values.erase(which);
+            ControllerState* controller = controllerByInstance(e.cdevice.which);
+            if (controller) {
+                SDL_GameControllerClose(controller->handle);
+                *controller = ControllerState();
                 std::cout << "Controller disconnected" << std::endl;
             }
             break;
@@ -165,33 +134,28 @@ void Input::ProcessEvent(const SDL_Event& e) {
         
         // Controller button events
         case SDL_CONTROLLERBUTTONDOWN: {
-            int which = e.cbutton.which;
-            SDL_GameControllerButton button = static_cast<SDL_GameControllerButton>(e.cbutton.button);
-            
-            if (controller_button_states[which][button] != INPUT_STATE_DOWN &&
-                controller_button_states[which][button] != INPUT_STATE_JUST_BECAME_DOWN) {
-                controller_button_states[which][button] = INPUT_STATE_JUST_BECAME_DOWN;
-                just_became_down_controller_buttons[which].push_back(button);
+            ControllerState* controller = controllerByInstance(e.cbutton.which);
+            if (controller && e.cbutton.button < SDL_CONTROLLER_BUTTON_MAX) {
+                controller->buttons[e.cbutton.button].press(frame);
             }
             break;
         }
         
         case SDL_CONTROLLERBUTTONUP: {
-            int which = e.cbutton.which;
-            SDL_GameControllerButton button = static_cast<SDL_GameControllerButton>(e.cbutton.button);
-            
-            if (controller_button_states[which][button] != INPUT_STATE_UP &&
-                controller_button_states[which][button] != INPUT_STATE_JUST_BECAME_UP) {
-                controller_button_states[which][button] = INPUT_STATE_JUST_BECAME_UP;
-                just_became_up_controller_buttons[which].push_back(button);
+            ControllerState* controller = controllerByInstance(e.cbutton.which);
+            if (controller && e.cbutton.button < SDL_CONTROLLER_BUTTON_MAX) {
+                controller->buttons[e.cbutton.button].release(frame);
             }
             break;
         }
         
         // Controller axis events
         case SDL_CONTROLLERAXISMOTION: {
-            int which = e.caxis.which;
-            SDL_GameControllerAxis axis = static_cast<SDL_GameControllerAxis>(e.caxis.axis);
+            ControllerState* controller = controllerByInstance(e.caxis.which);
+            if (!controller || e.caxis.axis >= SDL_CONTROLLER_AXIS_MAX) {
+                break;
+            }
+            
             // Convert from -32768 to 32767 range to -1.0 to 1.0 range
             float value = e.caxis.value / 32767.0f;
             
@@ -201,82 +165,30 @@ void Input::ProcessEvent(const SDL_Event& e) {
                 value = 0.0f;
             }
             
-            controller_axis_values[which][axis] = value;
+            controller->axes[e.caxis.axis] = value;
             break;
         }
     }
 }
 
-void Input::LateUpdate() {
-    // Update keyboard states
-    for (SDL_Scancode sc : just_became_down_scancodes) {
-        keyboard_states[sc] = INPUT_STATE_DOWN;
-    }
-    for (SDL_Scancode sc : just_became_up_scancodes) {
-        keyboard_states[sc] = INPUT_STATE_UP;
-    }
-    just_became_down_scancodes.clear();
-    just_became_up_scancodes.clear();
-    
-    // Update mouse button states
-    for (int button : just_became_down_buttons) {
-        mouse_button_states[button] = INPUT_STATE_DOWN;
-    }
-    for (int button : just_became_up_buttons) {
-        mouse_button_states[button] = INPUT_STATE_UP;
-    }
-    just_became_down_buttons.clear();
-    just_became_up_buttons.clear();
-    
-    // Reset scroll delta
-    mouse_scroll_this_frame = 0.0f;
-    
-    // Update controller button states
-    for (auto& [controller_id, buttons] : just_became_down_controller_buttons) {
-        for (SDL_GameControllerButton button : buttons) {
-            controller_button_states[controller_id][button] = INPUT_STATE_DOWN;
-        }
-        buttons.clear();
-    }
-    
-    for (auto& [controller_id, buttons] : just_became_up_controller_buttons) {
-        for (SDL_GameControllerButton button : buttons) {
-            controller_button_states[controller_id][button] = INPUT_STATE_UP;
-        }
-        buttons.clear();
-    }
-}
-
 // Keyboard input methods
-bool Input::GetKey(std::string keycode) {
-    auto it = __keycode_to_scancode.find(keycode);
-    
-    if (it == __keycode_to_scancode.end()) {
-        return false;
-    }
+SDL_Scancode Input::GetScancode(std::string_view keycode) {
+    // Views into the keys of __keycode_to_scancode, so lookups never build a std::string
+    static const std::unordered_map<std::string_view, SDL_Scancode> keycode_views = [] {
+        std::unordered_map<std::string_view, SDL_Scancode> views;
+        for (const auto& [name, scancode] : __keycode_to_scancode) {
+            views.emplace(name, scancode);
+        }
+        return views;
+    }();
     
-    INPUT_STATE state = keyboard_states[it->second];
-    return state == INPUT_STATE_DOWN || state == INPUT_STATE_JUST_BECAME_DOWN;
-}
-
-bool Input::GetKeyDown(std::string keycode) {
-    auto it = __keycode_to_scancode.find(keycode);
+    auto it = keycode_views.find(keycode);
     
-    if(it == __keycode_to_scancode.end()) {
-        return false;
-    }
-        
-    return keyboard_states[it->second] == INPUT_STATE_JUST_BECAME_DOWN;
-}
-
-bool Input::GetKeyUp(std::string keycode) {
-    auto it = __keycode_to_scancode.find(keycode);
-    
-    if (it == __keycode_to_scancode.end()) {
-        return false;
+    if (it == keycode_views.end()) {
+        return SDL_SCANCODE_UNKNOWN;
     }
     
-    return keyboard_states[it->second] == INPUT_STATE_JUST_BECAME_UP;
+    return it->second;
 }
 
 // Mouse input methods
@@ -284,19 +196,6 @@ glm::vec2 Input::GetMousePosition() {
     return mouse_position;
 }
 
-bool Input::GetMouseButton(int button) {
-    INPUT_STATE state = mouse_button_states[button];
-    return state == INPUT_STATE_DOWN || state == INPUT_STATE_JUST_BECAME_DOWN;
-}
-
-bool Input::GetMouseButtonDown(int button) {
-    return mouse_button_states[button] == INPUT_STATE_JUST_BECAME_DOWN;
-}
-
-bool Input::GetMouseButtonUp(int button) {
-    return mouse_button_states[button] == INPUT_STATE_JUST_BECAME_UP;
-}
-
 float Input::GetMouseScrollDelta() {
     return mouse_scroll_this_frame;
 }
@@ -327,52 +226,36 @@ SDL_GameControllerAxis Input::StringToAxis(const std::string& axisName) {
 }
 
 // Controller input methods
-bool Input::GetButton(int controllerIndex, std::string buttonName) {
-    // Check if controller exists
-    if (controllers.find(controllerIndex) == controllers.end()) {
-        return false;
+const ButtonState* Input::controllerButton(int controllerIndex, const std::string& buttonName) {
+    if (!IsControllerConnected(controllerIndex)) {
+        return nullptr;
     }
     
     SDL_GameControllerButton button = StringToButton(buttonName);
     if (button == SDL_CONTROLLER_BUTTON_INVALID) {
-        return false;
+        return nullptr;
     }
     
-    INPUT_STATE state = controller_button_states[controllerIndex][button];
-    return state == INPUT_STATE_DOWN || state == INPUT_STATE_JUST_BECAME_DOWN;
+    return &controllers[controllerIndex].buttons[button];
+}
+
+bool Input::GetButton(int controllerIndex, std::string buttonName) {
+    const ButtonState* state = controllerButton(controllerIndex, buttonName);
+    return state && state->down;
 }
 
 bool Input::GetButtonDown(int controllerIndex, std::string buttonName) {
-    // Check if controller exists
-    if (controllers.find(controllerIndex) == controllers.end()) {
-        return false;
-    }
-    
-    SDL_GameControllerButton button = StringToButton(buttonName);
-    if (button == SDL_CONTROLLER_BUTTON_INVALID) {
-        return false;
-    }
-    
-    return controller_button_states[controllerIndex][button] == INPUT_STATE_JUST_BECAME_DOWN;
+    const ButtonState* state = controllerButton(controllerIndex, buttonName);
+    return state && isDown(*state);
 }
 
 bool Input::GetButtonUp(int controllerIndex, std::string buttonName) {
-    // Check if controller exists
-    if (controllers.find(controllerIndex) == controllers.end()) {
-        return false;
-    }
-    
-    SDL_GameControllerButton button = StringToButton(buttonName);
-    if (button == SDL_CONTROLLER_BUTTON_INVALID) {
-        return false;
-    }
-    
-    return controller_button_states[controllerIndex][button] == INPUT_STATE_JUST_BECAME_UP;
+    const ButtonState* state = controllerButton(controllerIndex, buttonName);
+    return state && isUp(*state);
 }
 
 float Input::GetAxis(int controllerIndex, std::string axisName) {
-    // Check if controller exists
-    if (controllers.find(controllerIndex) == controllers.end()) {
+    if (!IsControllerConnected(controllerIndex)) {
         return 0.0f;
     }
     
@@ -381,28 +264,32 @@ float Input::GetAxis(int controllerIndex, std::string axisName) {
         return 0.0f;
     }
     
-    return controller_axis_values[controllerIndex][axis];
+    return controllers[controllerIndex].axes[axis];
 }
 
 bool Input::IsControllerConnected(int controllerIndex) {
-    return controllers.find(controllerIndex) != controllers.end();
+    return controllerIndex >= 0 && controllerIndex < MAX_CONTROLLERS && controllers[controllerIndex].handle != nullptr;
 }
 
 int Input::GetConnectedControllerCount() {
-    return static_cast<int>(controllers.size());
+    int count = 0;
+    for (const ControllerState& controller : controllers) {
+        if (controller.handle) {
+            count++;
+        }
+    }
+    return count;
 }
 
 std::string Input::GetControllerName(int controllerIndex) {
-    auto it = controllers.find(controllerIndex);
-    if (it != controllers.end()) {
-        return SDL_GameControllerName(it->second);
+    if (IsControllerConnected(controllerIndex)) {
+        return SDL_GameControllerName(controllers[controllerIndex].handle);
     }
     return "Not Connected";
 }
 
 bool Input::SetVibration(int controllerIndex, float leftMotor, float rightMotor, int durationMs) {
-    auto it = controllers.find(controllerIndex);
-    if (it == controllers.end()) {
+    if (!IsControllerConnected(controllerIndex)) {
         return false;
     }
     
@@ -410,12 +297,11 @@ bool Input::SetVibration(int controllerIndex, float leftMotor, float rightMotor,
     Uint16 lowFreq = static_cast<Uint16>(leftMotor * 65535.0f);
     Uint16 highFreq = static_cast<Uint16>(rightMotor * 65535.0f);
     
-    return SDL_GameControllerRumble(it->second, lowFreq, highFreq, durationMs) == 0;
+    return SDL_GameControllerRumble(controllers[controllerIndex].handle, lowFreq, highFreq, durationMs) == 0;
 }
 
 void Input::StopVibration(int controllerIndex) {
-    auto it = controllers.find(controllerIndex);
-    if (it != controllers.end()) {
-        SDL_GameControllerRumble(it->second, 0, 0, 0);
+    if (IsControllerConnected(controllerIndex)) {
+        SDL_GameControllerRumble(controllers[controllerIndex].handle, 0, 0, 0);
     }
 }
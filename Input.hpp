@@ -2,29 +2,71 @@
 #define INPUT_H
 
 #include "SDL/SDL.h"
+#include <string>
+#include <string_view>
+#include <array>
 #include <unordered_map>
 #include <vector>
+#include <cstdint>
 #include "glm/glm.hpp"
 
-enum INPUT_STATE { INPUT_STATE_UP, INPUT_STATE_JUST_BECAME_DOWN, INPUT_STATE_DOWN, INPUT_STATE_JUST_BECAME_UP };
+// Every button (keys, mouse buttons, controller buttons) is a slot in a fixed size array stamped
+// with the input frame it last changed in. "Just became down / up" is a stamp comparison against
+// the current frame, so LateUpdate only has to advance the frame counter.
+struct ButtonState {
+    bool down = false;
+    uint32_t down_frame = 0;
+    uint32_t up_frame = 0;
+    
+    void press(uint32_t frame) {
+        if (!down) {
+            down = true;
+            down_frame = frame;
+        }
+    }
+    void release(uint32_t frame) {
+        if (down) {
+            down = false;
+            up_frame = frame;
+        }
+    }
+};
+
+struct ControllerState {
+    SDL_GameController* handle = nullptr;
+    SDL_JoystickID instance_id = -1;
+    std::array<ButtonState, SDL_CONTROLLER_BUTTON_MAX> buttons{};
+    std::array<float, SDL_CONTROLLER_AXIS_MAX> axes{};
+};
 
 class Input
 {
 public:
+    static constexpr int MAX_MOUSE_BUTTONS = 8;
+    static constexpr int MAX_CONTROLLERS = 8;
+    
     static void Init();
     static void ProcessEvent(const SDL_Event & e);
-    static void LateUpdate();
+    static void LateUpdate() { frame++; mouse_scroll_this_frame = 0.0f; }
     static void Shutdown();
 
-    static bool GetKey(std::string keycode);
-    static bool GetKeyDown(std::string keycode);
-    static bool GetKeyUp(std::string keycode);
+    static bool GetKey(std::string_view keycode) { return GetKey(GetScancode(keycode)); }
+    static bool GetKeyDown(std::string_view keycode) { return GetKeyDown(GetScancode(keycode)); }
+    static bool GetKeyUp(std::string_view keycode) { return GetKeyUp(GetScancode(keycode)); }
+    
+    // Handle variants, scripts resolve a key name once with Input.Key and pass the scancode back.
+    // ProcessEvent never presses SDL_SCANCODE_UNKNOWN, so unknown names and handles read false.
+    static bool GetKey(SDL_Scancode scancode) { return keyboard_states[scancode].down; }
+    static bool GetKeyDown(SDL_Scancode scancode) { return isDown(keyboard_states[scancode]); }
+    static bool GetKeyUp(SDL_Scancode scancode) { return isUp(keyboard_states[scancode]); }
+    
+    static SDL_Scancode GetScancode(std::string_view keycode);
     
     static glm::vec2 GetMousePosition();
     
-    static bool GetMouseButton(int button);
-    static bool GetMouseButtonDown(int button);
-    static bool GetMouseButtonUp(int button);
+    static bool GetMouseButton(int button) { return mouseButton(button).down; }
+    static bool GetMouseButtonDown(int button) { return isDown(mouseButton(button)); }
+    static bool GetMouseButtonUp(int button) { return isUp(mouseButton(button)); }
     static float GetMouseScrollDelta();
     
     static void HideCursor();
@@ -50,22 +92,32 @@ public:
     
 
 private:
-    static inline std::unordered_map<SDL_Scancode, INPUT_STATE> keyboard_states;
-    static inline std::vector<SDL_Scancode> just_became_down_scancodes;
-    static inline std::vector<SDL_Scancode> just_became_up_scancodes;
+    // Starts at 1 so the zeroed stamps of untouched buttons never match it
+    static inline uint32_t frame = 1;
+    
+    static inline std::array<ButtonState, SDL_NUM_SCANCODES> keyboard_states{};
     
     static inline glm::vec2 mouse_position;
-    static inline std::unordered_map<int, INPUT_STATE> mouse_button_states;
-    static inline std::vector<int> just_became_down_buttons;
-    static inline std::vector<int> just_became_up_buttons;
+    static inline std::array<ButtonState, MAX_MOUSE_BUTTONS> mouse_button_states{};
     
     static inline float mouse_scroll_this_frame = 0;
     
-    static inline std::unordered_map<int, SDL_GameController*> controllers;
-    static inline std::unordered_map<int, std::unordered_map<SDL_GameControllerButton, INPUT_STATE>> controller_button_states;
-    static inline std::unordered_map<int, std::vector<SDL_GameControllerButton>> just_became_down_controller_buttons;
-    static inline std::unordered_map<int, std::vector<SDL_GameControllerButton>> just_became_up_controller_buttons;
-    static inline std::unordered_map<int, std::unordered_map<SDL_GameControllerAxis, float>> controller_axis_values;
+    // Scripts address controllers by slot, SDL events by joystick instance id
+    static inline std::array<ControllerState, MAX_CONTROLLERS> controllers{};
+    
+    static bool isDown(const ButtonState& state) { return state.down && state.down_frame == frame; }
+    static bool isUp(const ButtonState& state) { return !state.down && state.up_frame == frame; }
+    
+    // Out of range buttons read as this permanently released slot
+    static inline const ButtonState released{};
+    
+    static const ButtonState& mouseButton(int button) {
+        return button >= 0 && button < MAX_MOUSE_BUTTONS ? mouse_button_states[button] : released;
+    }
+    
+    static void openController(int device_index);
+    static ControllerState* controllerByInstance(SDL_JoystickID instance_id);
+    static const ButtonState* controllerButton(int controllerIndex, const std::string& buttonName);
     
     // Helper function to convert string to SDL_GameControllerButton
     static SDL_GameControllerButton StringToButton(const std::string& buttonName);
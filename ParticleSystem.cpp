@@ -109,6 +109,9 @@ void ParticleSystem::OnUpdate() {
         }
     }
     
+    // image can be reassigned from Lua at any time, resolve it once per frame rather than per particle
+    uint32_t image_id = StringTable::Intern(image);
+    
     for(int i = 0; i < particles.size(); i++) {
         Particle& particle = particles[i];
         
@@ -150,7 +153,7 @@ void ParticleSystem::OnUpdate() {
 
         }
         
-        Renderer::DrawEx(image, particle.x, particle.y, particle.rotation, particle.scale, particle.scale, pivot_x, pivot_y, particle.color.r, particle.color.g, particle.color.b, particle.color.a, sorting_order);
+        Renderer::DrawEx(image_id, particle.x, particle.y, particle.rotation, particle.scale, particle.scale, pivot_x, pivot_y, particle.color.r, particle.color.g, particle.color.b, particle.color.a, sorting_order);
         
         particle.frame_age++;
     }
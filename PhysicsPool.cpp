@@ -0,0 +1,85 @@
+//
+//  PhysicsPool.cpp
+//  game_engine
+//
+//  Created by Stanley  on 4/29/25.
+//
+
+#include "PhysicsPool.hpp"
+#include "Component.hpp"
+
+using namespace std;
+
+
+PhysicsPool::Slots<Collision> PhysicsPool::collisions;
+PhysicsPool::Slots<HitResult> PhysicsPool::hits;
+
+
+void PhysicsPool::configure(const rapidjson::Value& game_config){
+    if(game_config.HasMember("physics_pool_debug") && game_config["physics_pool_debug"].IsBool()){
+        debug = game_config["physics_pool_debug"].GetBool();
+    }
+}
+
+
+template <typename T>
+const luabridge::LuaRef& PhysicsPool::Slots<T>::acquire(const T& value){
+    if (used == values.size()){
+        // std::deque never moves existing elements, so neither the userdata pointers nor the refs move
+        values.push_back(value);
+        views.push_back(luabridge::LuaRef(Component::lua_state, &values.back()));
+    } else {
+        values[used] = value;
+    }
+    
+    values[used].frame = Helper::GetFrameNumber();
+    return views[used++];
+}
+
+
+const luabridge::LuaRef& PhysicsPool::collision(const Collision& value){
+    return collisions.acquire(value);
+}
+
+
+const luabridge::LuaRef& PhysicsPool::hit(Actor* actor, const b2Vec2& point, const b2Vec2& normal, bool is_trigger){
+    HitResult value;
+    value.actor = actor;
+    value.point = point;
+    value.normal = normal;
+    value.is_trigger = is_trigger;
+    return hits.acquire(value);
+}
+
+
+luabridge::LuaRef& PhysicsPool::list(){
+    if (lists_used == lists.size()){
+        lists.push_back(luabridge::newTable(Component::lua_state));
+    }
+    return lists[lists_used++];
+}
+
+
+void PhysicsPool::finishList(luabridge::LuaRef& list, int count){
+    lua_State* L = list.state();
+    list.push(L);
+    
+    int length = static_cast<int>(lua_rawlen(L, -1));
+    for (int i = count + 1; i <= length; i++){
+        lua_pushnil(L);
+        lua_rawseti(L, -2, i);
+    }
+    lua_pop(L, 1);
+}
+
+
+void PhysicsPool::recycle(){
+    collisions.used = 0;
+    hits.used = 0;
+    lists_used = 0;
+}
+
+
+void PhysicsPool::reportRetained(int frame, const char* type_name){
+    Component::reportError(string(type_name) + " from frame " + to_string(frame) + " read on frame " + to_string(Helper::GetFrameNumber()) + ", pooled physics results only live for the frame they were handed out in");
+}
@@ -0,0 +1,65 @@
+//
+//  PhysicsPool.hpp
+//  game_engine
+//
+//  Created by Stanley  on 4/29/25.
+//
+
+#ifndef PhysicsPool_hpp
+#define PhysicsPool_hpp
+
+#include <deque>
+#include <string>
+#include "lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "rapidjson/document.h"
+#include "Rigidbody.hpp"
+
+// Frame scoped Collision / HitResult objects for the main Lua state. Each slot owns one userdata
+// created the first time the slot is used, so handing a contact or a ray hit to Lua pushes an
+// existing object instead of boxing a new one. Everything handed out is recycled by recycle() at
+// the end of the frame, scripts must copy out what they want to keep. With "physics_pool_debug"
+// in game.config every field read checks the frame stamp and reports views kept past their frame.
+class PhysicsPool{
+public:
+    static inline bool debug = false;
+    
+    static void configure(const rapidjson::Value& game_config);
+    
+    // Copies value into a free slot and returns the slot's userdata, the reference stays valid for good
+    static const luabridge::LuaRef& collision(const Collision& value);
+    static const luabridge::LuaRef& hit(Actor* actor, const b2Vec2& point, const b2Vec2& normal, bool is_trigger);
+    
+    // Array table from the pool, entries past the ones the caller fills are cleared by finishList
+    static luabridge::LuaRef& list();
+    static void finishList(luabridge::LuaRef& list, int count);
+    
+    static void recycle();
+    
+    // Called by the Collision / HitResult getters
+    static void checkFrame(int frame, const char* type_name){
+        if (debug && frame != Helper::GetFrameNumber()){
+            reportRetained(frame, type_name);
+        }
+    }
+    
+private:
+    template <typename T>
+    struct Slots {
+        std::deque<T> values;
+        std::deque<luabridge::LuaRef> views;
+        size_t used = 0;
+        
+        const luabridge::LuaRef& acquire(const T& value);
+    };
+    
+    static Slots<Collision> collisions;
+    static Slots<HitResult> hits;
+    
+    static inline std::deque<luabridge::LuaRef> lists;
+    static inline size_t lists_used = 0;
+    
+    static void reportRetained(int frame, const char* type_name);
+};
+
+#endif /* PhysicsPool_hpp */
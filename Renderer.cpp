@@ -6,6 +6,8 @@
 //
 
 #include "Renderer.hpp"
+#include "StaticLayer.hpp"
+#include <cmath>
 
 using namespace std;
 
@@ -26,59 +28,108 @@ float Renderer::cam_ease_factor = 1.0f;
 
 glm::vec2 Renderer::cam_offset = glm::vec2(0.0f, 0.0f);
 
-int Renderer::request_order = 0;
+// Only DrawEx is numbered, from 1. Draw / DrawUI / DrawUIEx keep 0 and so stay under every DrawEx
+// of the same sorting order, in submission order among themselves.
+int Renderer::request_order = 1;
 
 
-SDL_Texture* ImageDB::loadImageTexture(SDL_Renderer* renderer, const string& image_name){
-    if(imageCache.find(image_name) != imageCache.end()){
-        return imageCache[image_name];
+ImageEntry& ImageDB::slot(uint32_t image_id){
+    if(image_id >= images.size()){
+        images.resize(image_id + 1);
     }
-    
+    return images[image_id];
+}
+
+
+const ImageEntry& ImageDB::loadImageSlow(SDL_Renderer* renderer, uint32_t image_id){
+    const string& image_name = StringTable::Get(image_id);
     string image_path = "resources/images/"+ image_name + ".png";
     
-    SDL_Texture* texture = IMG_LoadTexture(renderer, image_path.c_str());
+    SDL_Surface* surface = IMG_Load(image_path.c_str());
     
-    if(!texture){
+    if(!surface){
         cout << "error: missing image " << image_name;
         exit(0);
     }
     
-    imageCache[image_name] = texture;
-    return texture;
+    ImageEntry entry = addSurface(renderer, surface);
+    SDL_FreeSurface(surface);
+    
+    return slot(image_id) = entry;
+}
+
+
+int ImageDB::LuaHandle(lua_State* L){
+    uint32_t image_id = StringTable::FromLua(L, 1);
+    if(Renderer::getRenderer()){
+        loadImage(Renderer::getRenderer(), image_id);
+    }
+    lua_pushinteger(L, image_id);
+    return 1;
+}
+
+
+ImageEntry ImageDB::addSurface(SDL_Renderer* renderer, SDL_Surface* surface){
+    ImageEntry entry;
+    
+    // Pages blend, so only images SDL would have given a blended texture anyway (alpha channel or
+    // color key) go in. Opaque images keep their own SDL_BLENDMODE_NONE texture.
+    bool blended = surface->format->Amask != 0 || SDL_HasColorKey(surface);
+    SDL_Surface* converted = blended ? SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0) : nullptr;
+    if(converted && TextureAtlas::pack(renderer, converted, entry.texture, entry.src)){
+        entry.in_atlas = true;
+        entry.texture_w = TextureAtlas::page_size;
+        entry.texture_h = TextureAtlas::page_size;
+    }else{
+        // Opaque, too big for a page, or atlasing is off
+        entry.texture = SDL_CreateTextureFromSurface(renderer, surface);
+        entry.src = {0, 0, surface->w, surface->h};
+        entry.texture_w = surface->w;
+        entry.texture_h = surface->h;
+    }
+    
+    if(converted){
+        SDL_FreeSurface(converted);
+    }
+    return entry;
 }
 
 
 void ImageDB::clearCache(){
-    for(auto& pair: imageCache){
-        SDL_DestroyTexture(pair.second);
+    for(ImageEntry& entry : images){
+        if(entry.texture && !entry.in_atlas){
+            SDL_DestroyTexture(entry.texture);
+        }
     }
-    imageCache.clear();
+    images.clear();
+    TextureAtlas::clear();
 }
 
 
 void ImageDB::CreateDefaultParticletextureWithName(const std::string &name){
-    if(imageCache.find(name) != imageCache.end()){return;}
+    uint32_t image_id = StringTable::Intern(name);
+    if(image_id < images.size() && images[image_id].texture){return;}
     
     SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, 8, 8, 32, SDL_PIXELFORMAT_RGBA8888);
     
     Uint32 whit_color = SDL_MapRGBA(surface->format, 255, 255, 255, 255);
     SDL_FillRect(surface, NULL, whit_color);
     
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(Renderer::getRenderer(), surface);
+    slot(image_id) = addSurface(Renderer::getRenderer(), surface);
     
     SDL_FreeSurface(surface);
-    imageCache[name] = texture;
 }
 
 
 
-TTF_Font* FontDB::loadFontTexture(SDL_Renderer *renderer, const string &font_name, int font_size) {
-    if (fontCache.find(font_name) != fontCache.end()) {
-        if (fontCache[font_name].find(font_size) != fontCache[font_name].end()) {
-            return fontCache[font_name][font_size];
-        }
+TTF_Font* FontDB::loadFontTexture(SDL_Renderer *renderer, uint32_t font_id, int font_size) {
+    uint64_t cache_key = (static_cast<uint64_t>(font_id) << 32) | static_cast<uint32_t>(font_size);
+    auto cached = fontCache.find(cache_key);
+    if (cached != fontCache.end()) {
+        return cached->second;
     }
     
+    const std::string& font_name = StringTable::Get(font_id);
     std::string font_path = "resources/fonts/" + font_name + ".ttf";
     TTF_Font* font = TTF_OpenFont(font_path.c_str(), font_size);
     
@@ -87,22 +138,16 @@ TTF_Font* FontDB::loadFontTexture(SDL_Renderer *renderer, const string &font_nam
         exit(0);
     }
     
-    if (fontCache.find(font_name) == fontCache.end()) {
-        fontCache[font_name] = std::unordered_map<int, TTF_Font*>();
-    }
-    
-    fontCache[font_name][font_size] = font;
+    fontCache[cache_key] = font;
     
     return font;
 }
 
 
 void FontDB::clearCache() {
-    for (auto& [fontName, sizeMap] : fontCache) {
-        for (auto& [fontSize, fontPtr] : sizeMap) {
-            if (fontPtr != nullptr) {
-                TTF_CloseFont(fontPtr);
-            }
+    for (auto& [cacheKey, fontPtr] : fontCache) {
+        if (fontPtr != nullptr) {
+            TTF_CloseFont(fontPtr);
         }
     }
     fontCache.clear();
@@ -153,6 +198,12 @@ Renderer::Renderer() {
 
 
 Renderer::~Renderer() {
+    if (pixel_texture) {
+        SDL_DestroyTexture(pixel_texture);
+    }
+    TextCache::clear();
+    GlyphAtlas::clear();
+    StaticLayer::clear();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     ImageDB::clearCache();
@@ -162,14 +213,14 @@ Renderer::~Renderer() {
 
 
 
-void Renderer::DrawText(const std::string &text_content, float x, float y, std::string font_name, float font_size, float r, float g, float b, float a){
+void Renderer::DrawText(std::string_view text_content, float x, float y, uint32_t font, float font_size, float r, float g, float b, float a){
     
     TextRendereRequest request;
     
-    request.text = text_content;
+    request.text.assign(text_content);
     request.x = x;
     request.y = y;
-    request.font = font_name;
+    request.font = font;
     SDL_Color text_color = {Uint8(r),Uint8(g),Uint8(b),Uint8(a)};
     request.color = text_color;
     request.size = font_size;
@@ -179,61 +230,170 @@ void Renderer::DrawText(const std::string &text_content, float x, float y, std::
 
 
 void Renderer::render(){
+    stats = RenderStats();
+    
+    StaticLayer::prepare(renderer, sceneToDraw);
+    
     SDL_RenderSetScale(renderer, zoom_factor, zoom_factor);
 
-    while (!sceneToDraw.empty()) {
-        ImageRenderRequest request = sceneToDraw.top();
-        sceneToDraw.pop();
-        renderScene(request);
+    glm::vec2 screen(window_size.x / (2.0f * zoom_factor), window_size.y / (2.0f * zoom_factor));
+    sortCommands(sceneToDraw, true);
+    for (const DrawSortEntry& entry : sort_entries) {
+        renderScene(sceneToDraw[entry.index], screen, current_cam_pos);
     }
+    sceneToDraw.clear();
+    flushSprites();
     
     
     SDL_RenderSetScale(renderer, 1.0f, 1.0f);
     
-    while (!UIToDraw.empty()) {
-        ImageRenderRequest request = UIToDraw.top();
-        UIToDraw.pop();
-        renderUI(request);
+    sortCommands(UIToDraw, false);
+    for (const DrawSortEntry& entry : sort_entries) {
+        renderUI(UIToDraw[entry.index]);
     }
+    UIToDraw.clear();
+    flushSprites();
+    
+    request_order = 1;
     
 
     while(!textToDraw.empty()){
-        TextRendereRequest request = textToDraw.front();
+        renderText(textToDraw.front());
         textToDraw.pop();
-        
-        renderText(request);
     }
+    flushSprites();
+    TextCache::endFrame();
 
     
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+    if(!pixelToDraw.empty()){
+        if(pixel_mode == PixelMode::Texture){
+            renderPixelTexture();
+        }else{
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_BLEND);
+            renderPixelRuns();
+            SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+        }
+        pixelToDraw.clear();
+    }
+    
+    last_stats = stats;
+}
+
+
+// Culls, then runs a stable LSD radix sort of (sorting_order, request_order) packed into one 64-bit key,
+// one byte per pass. Passes where every key has the same byte are skipped, which is most of them.
+// Culling happens here rather than in DrawEx since the camera only settles after OnLateUpdate.
+void Renderer::sortCommands(const std::vector<ImageRenderRequest>& commands, bool scene){
+    sort_entries.clear();
     
-    while(!pixelToDraw.empty()){
-        PixelRenderRequest request =  pixelToDraw.front();
-        pixelToDraw.pop();
-        renderPixel(request);
+    for (size_t i = 0; i < commands.size(); i++) {
+        if (sprite_culling && !isVisible(commands[i], scene)) {
+            stats.culled++;
+            continue;
+        }
+        
+        // Flipping the sign bit makes negative values sort below positive ones as unsigned
+        uint64_t order = static_cast<uint32_t>(commands[i].sorting_order) ^ 0x80000000u;
+        uint64_t submitted = static_cast<uint32_t>(commands[i].request_order) ^ 0x80000000u;
+        sort_entries.push_back({(order << 32) | submitted, static_cast<uint32_t>(i)});
     }
     
-    SDL_SetRenderDrawBlendMode(renderer, SDL_BLENDMODE_NONE);
+    size_t count = sort_entries.size();
+    sort_scratch.resize(count);
+    
+    for (int shift = 0; shift < 64; shift += 8) {
+        size_t buckets[256] = {};
+        for (const DrawSortEntry& entry : sort_entries) {
+            buckets[(entry.key >> shift) & 0xFF]++;
+        }
+        if (count == 0 || buckets[(sort_entries[0].key >> shift) & 0xFF] == count) {
+            continue;
+        }
+        
+        size_t offset = 0;
+        for (size_t& bucket : buckets) {
+            size_t size = bucket;
+            bucket = offset;
+            offset += size;
+        }
+        for (const DrawSortEntry& entry : sort_entries) {
+            sort_scratch[buckets[(entry.key >> shift) & 0xFF]++] = entry;
+        }
+        sort_entries.swap(sort_scratch);
+    }
 }
 
 
-void Renderer::renderText(TextRendereRequest request){
+bool Renderer::isVisible(const ImageRenderRequest& request, bool scene){
+    const ImageEntry& image = ImageDB::loadImage(renderer, request.image);
+    float width = image.src.w * std::abs(request.scale_x);
+    float height = image.src.h * std::abs(request.scale_y);
+    
+    if (!scene) {
+        return request.x < window_size.x && request.y < window_size.y && request.x + width >= 0.0f && request.y + height >= 0.0f;
+    }
+    
+    // Any rotation about the pivot stays within this distance of the anchor, plus a pixel for truncation
+    float reach = width + height + std::abs(request.pivot_x * width) + std::abs(request.pivot_y * height) + 1.0f;
+    
+    float dx = std::abs((request.x - current_cam_pos.x) * 100.0f);
+    float dy = std::abs((request.y - current_cam_pos.y) * 100.0f);
+    
+    return dx <= window_size.x / (2.0f * zoom_factor) + reach && dy <= window_size.y / (2.0f * zoom_factor) + reach;
+}
+
+
+void Renderer::renderText(const TextRendereRequest& request){
     TTF_Font* font_texture = FontDB::loadFontTexture(renderer, request.font, request.size);
     
-    SDL_Surface* surface = TTF_RenderText_Solid(font_texture, request.text.c_str(), request.color);
+    const CachedText* text = nullptr;
+    if (text_mode != TextMode::Glyphs){
+        text = TextCache::get(renderer, font_texture, request.font, static_cast<int>(request.size), request.color, request.text, text_mode == TextMode::Auto);
+    }
+    
+    if (!text){
+        if (text_mode != TextMode::Cached){
+            renderTextGlyphs(request, font_texture);
+        }
+        return;
+    }
     
-    SDL_Texture* texture = SDL_CreateTextureFromSurface(renderer, surface);
+    // Glyph quads queued by earlier text have to land first
+    flushSprites();
     
-    SDL_FRect rect = {request.x, request.y, static_cast<float>(surface->w), static_cast<float>(surface->h)};
+    SDL_FRect rect = {request.x, request.y, static_cast<float>(text->width), static_cast<float>(text->height)};
     
-    Helper::SDL_RenderCopy(renderer, texture, nullptr, &rect);
+    Helper::SDL_RenderCopy(renderer, text->texture, nullptr, &rect);
+    stats.draw_calls++;
+}
+
+
+void Renderer::renderTextGlyphs(const TextRendereRequest& request, TTF_Font* font){
+    FontGlyphs& glyphs = GlyphAtlas::forFont(font, request.font, static_cast<int>(request.size));
     
-    SDL_FreeSurface(surface);
-    SDL_DestroyTexture(texture);
+    float pen_x = request.x;
+    unsigned char previous = 0;
+    const SDL_FPoint no_pivot = {0.0f, 0.0f};
+    
+    for (char c : request.text){
+        unsigned char character = static_cast<unsigned char>(c);
+        if (previous){
+            pen_x += GlyphAtlas::kerning(glyphs, previous, character);
+        }
+        
+        const Glyph& glyph = GlyphAtlas::glyph(renderer, glyphs, character);
+        if (glyph.image.texture){
+            SDL_FRect dst_rect = {pen_x, request.y, static_cast<float>(glyph.image.src.w), static_cast<float>(glyph.image.src.h)};
+            submitSprite(glyph.image, dst_rect, 0.0f, no_pivot, SDL_FLIP_NONE, request.color);
+        }
+        
+        pen_x += glyph.advance;
+        previous = character;
+    }
 }
 
 
-void Renderer::PlayAudio(int channel, std::string clip_name, bool does_loop){
+void Renderer::PlayAudio(int channel, const std::string& clip_name, bool does_loop){
     
     Mix_Chunk* bgm = AudioDB::loadAudio(clip_name);
     if (bgm) {
@@ -258,42 +418,42 @@ void Renderer::SetAudioVolume(int channel, float volume){
 }
 
 
-void Renderer::DrawUI(std::string image_name, float x, float y){
+void Renderer::DrawUI(uint32_t image, float x, float y){
     ImageRenderRequest request;
-    request.image = image_name;
+    request.image = image;
     request.x = x;
     request.y = y;
     
-    UIToDraw.push(request);
+    UIToDraw.push_back(request);
 }
 
 
-void Renderer::DrawUIEx(std::string image_name, float x, float y, float r, float g, float b, float a, float sorting_order){
+void Renderer::DrawUIEx(uint32_t image, float x, float y, float r, float g, float b, float a, float sorting_order){
     ImageRenderRequest request;
-    request.image = image_name;
+    request.image = image;
     request.x = x;
     request.y = y;
     SDL_Color color = {Uint8(r),Uint8(g),Uint8(b),Uint8(a)};
     request.color = color;
     request.sorting_order = int(sorting_order);
     
-    UIToDraw.push(request);
+    UIToDraw.push_back(request);
 }
 
 
-void Renderer::Draw(std::string image_name, float x, float y){
+void Renderer::Draw(uint32_t image, float x, float y){
     ImageRenderRequest request;
-    request.image = image_name;
+    request.image = image;
     request.x = x;
     request.y = y;
     
-    sceneToDraw.push(request);
+    sceneToDraw.push_back(request);
 }
 
 
-void Renderer::DrawEx(std::string image_name, float x, float y, float rotation_degrees, float scale_x, float scale_y, float pivot_x, float pivot_y, float r, float g, float b, float a, float sorting_order){
+void Renderer::DrawEx(uint32_t image, float x, float y, float rotation_degrees, float scale_x, float scale_y, float pivot_x, float pivot_y, float r, float g, float b, float a, float sorting_order){
     ImageRenderRequest request;
-    request.image = image_name;
+    request.image = image;
     request.x = x;
     request.y = y;
     request.rotation = static_cast<int>(rotation_degrees);
@@ -305,10 +465,9 @@ void Renderer::DrawEx(std::string image_name, float x, float y, float rotation_d
     request.color = color;
     request.sorting_order = int(sorting_order);
     
-    request.request_order = request_order;
-    request_order++;
+    request.request_order = request_order++;
     
-    sceneToDraw.push(request);
+    sceneToDraw.push_back(request);
 }
 
 
@@ -319,22 +478,15 @@ void Renderer::DrawPixel(float x, float y, float r, float g, float b, float a){
     request.y = static_cast<int>(y);
     request.color = color;
     
-    pixelToDraw.push(request);
+    pixelToDraw.push_back(request);
 }
 
 
-void Renderer::renderScene(ImageRenderRequest request){
-    SDL_Texture* texture = ImageDB::loadImageTexture(renderer, request.image);
-    
-    SDL_SetTextureColorMod(texture, request.color.r, request.color.g, request.color.b);
-    SDL_SetTextureAlphaMod(texture, request.color.a);
+void Renderer::renderScene(const ImageRenderRequest& request, const glm::vec2& screen, const glm::vec2& camera){
+    const ImageEntry& image = ImageDB::loadImage(renderer, request.image);
     
-    
-    float image_width = 0.0f, image_height = 0.0f;
-    Helper::SDL_QueryTexture(texture, &image_width, &image_height);
-    
-    float screenX = (window_size.x / (2.0f * zoom_factor));
-    float screenY = (window_size.y / (2.0f * zoom_factor));
+    float image_width = static_cast<float>(image.src.w);
+    float image_height = static_cast<float>(image.src.h);
 
     
 //    int pivot_x = static_cast<int>(request.pivot_x * image_width * request.scale_x);
@@ -350,8 +502,8 @@ void Renderer::renderScene(ImageRenderRequest request){
     dst_rect.w = image_width * glm::abs(request.scale_x);
     dst_rect.h = image_height * glm::abs(request.scale_y);
     
-    dst_rect.x = screenX + (request.x - current_cam_pos.x) * 100.0f - pivot_x;
-    dst_rect.y = screenY + (request.y - current_cam_pos.y) * 100.0f - pivot_y;
+    dst_rect.x = screen.x + (request.x - camera.x) * 100.0f - pivot_x;
+    dst_rect.y = screen.y + (request.y - camera.y) * 100.0f - pivot_y;
 
     SDL_RendererFlip flip = SDL_FLIP_NONE;
     if (request.scale_x < 0) {
@@ -363,22 +515,62 @@ void Renderer::renderScene(ImageRenderRequest request){
     
     SDL_FPoint rotation_center = {static_cast<float>(pivot_x), static_cast<float>(pivot_y)};
     
-    Helper::SDL_RenderCopyEx(0, "", renderer, texture, nullptr, &dst_rect, request.rotation, &rotation_center, flip);
-    
-    SDL_SetTextureColorMod(texture, 255, 255, 255);
-    SDL_SetTextureAlphaMod(texture, 255);
+    submitSprite(image, dst_rect, request.rotation, rotation_center, flip, request.color);
 }
 
 
-void Renderer::renderUI(ImageRenderRequest request){
-    SDL_Texture* texture = ImageDB::loadImageTexture(renderer, request.image);
+// Sprites blend into the target with premultiplied results (color scaled by source alpha, alpha
+// accumulated) so a translucent edge over an empty target isn't darkened twice when the target
+// is composited. Falls back to plain blending where custom blend modes aren't supported.
+void Renderer::renderToTarget(SDL_Texture* target, const glm::vec2& camera, const std::vector<ImageRenderRequest>& requests){
+    flushSprites();
+    SDL_SetRenderTarget(renderer, target);
+    SDL_RenderSetScale(renderer, 1.0f, 1.0f);
     
-    SDL_SetTextureColorMod(texture, request.color.r, request.color.g, request.color.b);
-    SDL_SetTextureAlphaMod(texture, request.color.a);
+    Uint8 oldR, oldG, oldB, oldA;
+    SDL_GetRenderDrawColor(renderer, &oldR, &oldG, &oldB, &oldA);
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 0);
+    SDL_RenderClear(renderer);
+    SDL_SetRenderDrawColor(renderer, oldR, oldG, oldB, oldA);
+    
+    SDL_BlendMode into_target = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_SRC_ALPHA, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                                                           SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+    
+    // Textures get their own blend mode back once the batch is out
+    std::vector<std::pair<SDL_Texture*, SDL_BlendMode>>& restore = target_blend_modes;
+    restore.clear();
+    
+    for (const ImageRenderRequest& request : requests) {
+        SDL_Texture* texture = ImageDB::loadImage(renderer, request.image).texture;
+        bool seen = false;
+        for (const auto& [known, mode] : restore) {
+            seen = seen || known == texture;
+        }
+        if (!seen) {
+            SDL_BlendMode mode;
+            SDL_GetTextureBlendMode(texture, &mode);
+            restore.push_back({texture, mode});
+            SDL_SetTextureBlendMode(texture, into_target);
+        }
+        
+        renderScene(request, glm::vec2(0.0f, 0.0f), camera);
+    }
+    flushSprites();
     
+    for (const auto& [texture, mode] : restore) {
+        SDL_SetTextureBlendMode(texture, mode);
+    }
     
-    float image_width = 0.0f, image_height = 0.0f;
-    Helper::SDL_QueryTexture(texture, &image_width, &image_height);
+    SDL_SetRenderTarget(renderer, nullptr);
+    stats.static_rebuilds++;
+}
+
+
+void Renderer::renderUI(const ImageRenderRequest& request){
+    const ImageEntry& image = ImageDB::loadImage(renderer, request.image);
+    
+    float image_width = static_cast<float>(image.src.w);
+    float image_height = static_cast<float>(image.src.h);
     
 //    float screenX = (window_size.x / (2.0f));
 //    float screenY = (window_size.y / (2.0f));
@@ -403,34 +595,199 @@ void Renderer::renderUI(ImageRenderRequest request){
     
 //    SDL_FPoint rotation_center = {static_cast<float>(pivot_x), static_cast<float>(pivot_y)};
     
-    Helper::SDL_RenderCopyEx(
-        0,
-        "",
-        renderer,
-        texture,
-        nullptr,
-        &dst_rect,
-        request.rotation,
-        &rotation_center,
-        SDL_FLIP_NONE
-    );
+    submitSprite(image, dst_rect, request.rotation, rotation_center, SDL_FLIP_NONE, request.color);
+}
+
+
+void Renderer::submitSprite(const ImageEntry& image, const SDL_FRect& dst_rect, float angle, const SDL_FPoint& center, SDL_RendererFlip flip, SDL_Color color){
+    stats.sprites++;
+    SDL_Texture* texture = image.texture;
     
+    if (!sprite_batching){
+        SDL_SetTextureColorMod(texture, color.r, color.g, color.b);
+        SDL_SetTextureAlphaMod(texture, color.a);
+        
+        SDL_FRect src_rect = {static_cast<float>(image.src.x), static_cast<float>(image.src.y),
+                              static_cast<float>(image.src.w), static_cast<float>(image.src.h)};
+        Helper::SDL_RenderCopyEx(0, "", renderer, texture, &src_rect, &dst_rect, angle, &center, flip);
+        
+        SDL_SetTextureColorMod(texture, 255, 255, 255);
+        SDL_SetTextureAlphaMod(texture, 255);
+        
+        stats.draw_calls++;
+        stats.texture_binds++;
+        return;
+    }
+    
+    if (texture != batch_texture){
+        flushSprites();
+        batch_texture = texture;
+    }
+    
+    // Same integer truncation Helper::SDL_RenderCopyEx applies, so both paths land on the same pixels
+    float x = static_cast<float>(static_cast<int>(dst_rect.x));
+    float y = static_cast<float>(static_cast<int>(dst_rect.y));
+    float w = static_cast<float>(static_cast<int>(dst_rect.w));
+    float h = static_cast<float>(static_cast<int>(dst_rect.h));
+    float center_x = x + static_cast<float>(static_cast<int>(center.x));
+    float center_y = y + static_cast<float>(static_cast<int>(center.y));
+    
+    float u0 = static_cast<float>(image.src.x) / image.texture_w;
+    float u1 = static_cast<float>(image.src.x + image.src.w) / image.texture_w;
+    float v0 = static_cast<float>(image.src.y) / image.texture_h;
+    float v1 = static_cast<float>(image.src.y + image.src.h) / image.texture_h;
+    if (flip & SDL_FLIP_HORIZONTAL){
+        std::swap(u0, u1);
+    }
+    if (flip & SDL_FLIP_VERTICAL){
+        std::swap(v0, v1);
+    }
     
-    SDL_SetTextureColorMod(texture, 255, 255, 255);
-    SDL_SetTextureAlphaMod(texture, 255);
+    // Clockwise around the center in screen space, like SDL_RenderCopyEx
+    float radians = angle * (static_cast<float>(M_PI) / 180.0f);
+    float c = std::cos(radians);
+    float s = std::sin(radians);
+    
+    const float corners[4][4] = {
+        {x,     y,     u0, v0},
+        {x + w, y,     u1, v0},
+        {x + w, y + h, u1, v1},
+        {x,     y + h, u0, v1},
+    };
+    
+    int base = static_cast<int>(batch_vertices.size());
+    for (const auto& corner : corners){
+        float dx = corner[0] - center_x;
+        float dy = corner[1] - center_y;
+        
+        SDL_Vertex vertex;
+        vertex.position.x = center_x + dx * c - dy * s;
+        vertex.position.y = center_y + dx * s + dy * c;
+        vertex.color = color;
+        vertex.tex_coord.x = corner[2];
+        vertex.tex_coord.y = corner[3];
+        batch_vertices.push_back(vertex);
+    }
+    
+    const int quad[6] = {0, 1, 2, 0, 2, 3};
+    for (int index : quad){
+        batch_indices.push_back(base + index);
+    }
 }
 
 
-void Renderer::renderPixel(PixelRenderRequest request){
+void Renderer::flushSprites(){
+    if (batch_vertices.empty()){
+        return;
+    }
+    
+    SDL_RenderGeometry(renderer, batch_texture, batch_vertices.data(), static_cast<int>(batch_vertices.size()),
+                       batch_indices.data(), static_cast<int>(batch_indices.size()));
+    
+    stats.draw_calls++;
+    stats.texture_binds++;
+    
+    batch_vertices.clear();
+    batch_indices.clear();
+    batch_texture = nullptr;
+}
+
+
+void Renderer::SetPixelMode(const std::string& mode){
+    pixel_mode = mode == "texture" ? PixelMode::Texture : PixelMode::Runs;
+}
+
+
+int Renderer::LuaGetStats(lua_State* L){
+    lua_createtable(L, 0, 5);
+    lua_pushinteger(L, last_stats.sprites);
+    lua_setfield(L, -2, "sprites");
+    lua_pushinteger(L, last_stats.draw_calls);
+    lua_setfield(L, -2, "draw_calls");
+    lua_pushinteger(L, last_stats.texture_binds);
+    lua_setfield(L, -2, "texture_binds");
+    lua_pushinteger(L, last_stats.culled);
+    lua_setfield(L, -2, "culled");
+    lua_pushinteger(L, last_stats.static_rebuilds);
+    lua_setfield(L, -2, "static_rebuilds");
+    return 1;
+}
+
+
+void Renderer::renderPixelRuns(){
     Uint8 oldR, oldG, oldB, oldA;
     SDL_GetRenderDrawColor(renderer, &oldR, &oldG, &oldB, &oldA);
-        
-    SDL_SetRenderDrawColor(renderer, request.color.r, request.color.g, request.color.b, request.color.a);
     
-    SDL_RenderDrawPoint(renderer, request.x, request.y);
+    size_t start = 0;
+    while(start < pixelToDraw.size()){
+        SDL_Color color = pixelToDraw[start].color;
+        
+        pixel_points.clear();
+        size_t end = start;
+        while(end < pixelToDraw.size()){
+            const PixelRenderRequest& request = pixelToDraw[end];
+            if(request.color.r != color.r || request.color.g != color.g || request.color.b != color.b || request.color.a != color.a){
+                break;
+            }
+            pixel_points.push_back({request.x, request.y});
+            end++;
+        }
+        
+        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
+        SDL_RenderDrawPoints(renderer, pixel_points.data(), static_cast<int>(pixel_points.size()));
+        stats.draw_calls++;
+        
+        start = end;
+    }
     
     SDL_SetRenderDrawColor(renderer, oldR, oldG, oldB, oldA);
+}
+
+
+void Renderer::renderPixelTexture(){
+    int width = static_cast<int>(window_size.x);
+    int height = static_cast<int>(window_size.y);
     
+    if(!pixel_texture){
+        pixel_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, width, height);
+        SDL_SetTextureBlendMode(pixel_texture, SDL_BLENDMODE_BLEND);
+        pixel_buffer.assign(static_cast<size_t>(width) * height, 0);
+    }
+    
+    for(const PixelRenderRequest& request : pixelToDraw){
+        if(request.x < 0 || request.y < 0 || request.x >= width || request.y >= height || request.color.a == 0){
+            continue;
+        }
+        
+        int index = request.y * width + request.x;
+        Uint32& dst = pixel_buffer[index];
+        if(dst == 0){
+            pixel_dirty.push_back(index);
+        }
+        
+        // Straight alpha "over", the same blend SDL_BLENDMODE_BLEND applies to each point
+        float src_a = request.color.a / 255.0f;
+        float dst_a = (dst >> 24) / 255.0f;
+        float out_a = src_a + dst_a * (1.0f - src_a);
+        auto channel = [&](Uint8 src, int shift){
+            float dst_c = ((dst >> shift) & 0xFF) * dst_a * (1.0f - src_a);
+            return static_cast<Uint32>((src * src_a + dst_c) / out_a + 0.5f) << shift;
+        };
+        dst = (static_cast<Uint32>(out_a * 255.0f + 0.5f) << 24) | channel(request.color.r, 16) | channel(request.color.g, 8) | channel(request.color.b, 0);
+    }
+    
+    if(pixel_dirty.empty()){
+        return;
+    }
+    
+    SDL_UpdateTexture(pixel_texture, nullptr, pixel_buffer.data(), width * static_cast<int>(sizeof(Uint32)));
+    Helper::SDL_RenderCopy(renderer, pixel_texture, nullptr, nullptr);
+    stats.draw_calls++;
+    
+    for(int index : pixel_dirty){
+        pixel_buffer[index] = 0;
+    }
+    pixel_dirty.clear();
 }
 
 
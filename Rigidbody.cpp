@@ -10,6 +10,7 @@
 #include "Scene.hpp"
 #include "Engine.hpp"
 #include "Component.hpp"
+#include "PhysicsPool.hpp"
 #include "box2d/box2d.h"
 
 using namespace std;
@@ -17,6 +18,9 @@ using namespace std;
 
 bool RigidbodyManager::has_been_initialized = false;
 b2World* RigidbodyManager::physics_world = nullptr;
+std::vector<ContactEvent> RigidbodyManager::pending_contacts;
+std::vector<ContactEvent> RigidbodyManager::delivering_contacts;
+std::unordered_map<Actor*, size_t> RigidbodyManager::contact_order;
 
 
 b2Vec2 Rigidbody::GetPosition(){
@@ -35,6 +39,17 @@ float Rigidbody::GetRotation(){
 }
 
 
+Actor* HitResult::GetActor() const { PhysicsPool::checkFrame(frame, "HitResult"); return actor; }
+b2Vec2 HitResult::GetPoint() const { PhysicsPool::checkFrame(frame, "HitResult"); return point; }
+b2Vec2 HitResult::GetNormal() const { PhysicsPool::checkFrame(frame, "HitResult"); return normal; }
+bool HitResult::GetIsTrigger() const { PhysicsPool::checkFrame(frame, "HitResult"); return is_trigger; }
+
+Actor* Collision::GetOther() const { PhysicsPool::checkFrame(frame, "Collision"); return other; }
+b2Vec2 Collision::GetPoint() const { PhysicsPool::checkFrame(frame, "Collision"); return point; }
+b2Vec2 Collision::GetNormal() const { PhysicsPool::checkFrame(frame, "Collision"); return normal; }
+b2Vec2 Collision::GetRelativeVelocity() const { PhysicsPool::checkFrame(frame, "Collision"); return relative_velocity; }
+
+
 void RigidbodyManager::Initialize(){
     if(has_been_initialized){
         return;
@@ -56,6 +71,62 @@ void RigidbodyManager::Step(){
     }
     
     physics_world->Step(1.0f / 60.0f, 8, 3);
+    
+    deliverContacts();
+}
+
+
+void RigidbodyManager::queueContact(Actor* actor, ContactEvent::Kind kind, const Collision& collision){
+    if (actor == nullptr){
+        return;
+    }
+    
+    ContactEvent event;
+    event.actor = actor;
+    event.kind = kind;
+    event.collision = collision;
+    event.collision.frame = Helper::GetFrameNumber();
+    event.view = &PhysicsPool::collision(event.collision);
+    
+    // Outside of Step (a body destroyed from a script ends its contacts) there is nothing to batch with
+    if (!physics_world->IsLocked()){
+        actor->deliverContacts(&event, 1);
+        return;
+    }
+    
+    pending_contacts.push_back(event);
+}
+
+
+void RigidbodyManager::deliverContacts(){
+    if (pending_contacts.empty()){
+        return;
+    }
+    
+    // Group each actor's contacts together, actors keep the order they first touched something in
+    contact_order.clear();
+    for (ContactEvent& event : pending_contacts){
+        event.actor_order = contact_order.emplace(event.actor, contact_order.size()).first->second;
+    }
+    std::stable_sort(pending_contacts.begin(), pending_contacts.end(), [](const ContactEvent& a, const ContactEvent& b){
+        return a.actor_order < b.actor_order;
+    });
+    
+    // Swap out first, callbacks destroying bodies must not touch the buffer being walked
+    delivering_contacts.swap(pending_contacts);
+    pending_contacts.clear();
+    
+    size_t begin = 0;
+    while (begin < delivering_contacts.size()){
+        size_t end = begin + 1;
+        while (end < delivering_contacts.size() && delivering_contacts[end].actor == delivering_contacts[begin].actor){
+            end++;
+        }
+        delivering_contacts[begin].actor->deliverContacts(&delivering_contacts[begin], end - begin);
+        begin = end;
+    }
+    
+    delivering_contacts.clear();
 }
 
 
@@ -159,6 +230,10 @@ void Rigidbody::OnDestroy() {
         RigidbodyManager::physics_world->DestroyBody(body);
         body = nullptr;
     }
+    
+    if (actor != nullptr && actor->rigidbody == this) {
+        actor->rigidbody = nullptr;
+    }
 }
 
 
@@ -258,6 +333,38 @@ b2Vec2 Rigidbody::GetRightDirection() {
 }
 
 
+int Rigidbody::GetPositionXY(lua_State* L){
+    b2Vec2 position = GetPosition();
+    lua_pushnumber(L, position.x);
+    lua_pushnumber(L, position.y);
+    return 2;
+}
+
+
+int Rigidbody::LuaGetPosition(lua_State* L){
+    luabridge::Stack<b2Vec2>::push(L, GetPosition());
+    return 1;
+}
+
+
+int Rigidbody::GetVelocityXY(lua_State* L){
+    b2Vec2 velocity = body ? body->GetLinearVelocity() : b2Vec2(0.0f, 0.0f);
+    lua_pushnumber(L, velocity.x);
+    lua_pushnumber(L, velocity.y);
+    return 2;
+}
+
+
+int Rigidbody::SetVelocityXY(lua_State* L){
+    if (body){
+        float velocity_x = static_cast<float>(luaL_checknumber(L, 2));
+        float velocity_y = static_cast<float>(luaL_checknumber(L, 3));
+        body->SetLinearVelocity(b2Vec2(velocity_x, velocity_y));
+    }
+    return 0;
+}
+
+
 void ContactListener::BeginContact(b2Contact *contact){
     b2Fixture* fixtureA = contact->GetFixtureA();
     b2Fixture* fixtureB = contact->GetFixtureB();
@@ -279,19 +386,19 @@ void ContactListener::BeginContact(b2Contact *contact){
         collision.other = actorB;
         collision.point = world_manifold.points[0];
         collision.normal = world_manifold.normal;
-        actorA->onCollisionEnter(collision);
+        RigidbodyManager::queueContact(actorA, ContactEvent::CollisionEnter, collision);
                 
         collision.other = actorA;
-        actorB->onCollisionEnter(collision);
+        RigidbodyManager::queueContact(actorB, ContactEvent::CollisionEnter, collision);
     }else if(fixtureA->IsSensor() && fixtureB->IsSensor()){
         collision.point = b2Vec2(-999.0f, -999.0f);
         collision.normal = b2Vec2(-999.0f, -999.0f);
         
         collision.other = actorB;
-        actorA->onTriggerEnter(collision);
+        RigidbodyManager::queueContact(actorA, ContactEvent::TriggerEnter, collision);
         
         collision.other = actorA;
-        actorB->onTriggerEnter(collision);
+        RigidbodyManager::queueContact(actorB, ContactEvent::TriggerEnter, collision);
     }
 }
 
@@ -319,16 +426,16 @@ void ContactListener::EndContact(b2Contact *contact){
     
     if(!fixtureA->IsSensor() && !fixtureB->IsSensor()){
         collision.other = actorB;
-        actorA->onCollisionExit(collision);
+        RigidbodyManager::queueContact(actorA, ContactEvent::CollisionExit, collision);
         
         collision.other = actorA;
-        actorB->onCollisionExit(collision);
+        RigidbodyManager::queueContact(actorB, ContactEvent::CollisionExit, collision);
     }else if(fixtureA->IsSensor() && fixtureB->IsSensor()){
         collision.other = actorB;
-        actorA->onTriggerExit(collision);
+        RigidbodyManager::queueContact(actorA, ContactEvent::TriggerExit, collision);
         
         collision.other = actorA;
-        actorB->onTriggerExit(collision);
+        RigidbodyManager::queueContact(actorB, ContactEvent::TriggerExit, collision);
     }
 }
 
@@ -359,22 +466,17 @@ luabridge::LuaRef RigidbodyManager::Raycast(const b2Vec2& pos, const b2Vec2& dir
         return luabridge::LuaRef(Component::lua_state); // Return nil
     }
     
-    // Create and populate a HitResult object
-    luabridge::LuaRef hitResult = luabridge::newTable(Component::lua_state);
-    hitResult["actor"] = callback.m_actor;
-    hitResult["point"] = callback.m_point;
-    hitResult["normal"] = callback.m_normal;
-    hitResult["is_trigger"] = callback.m_is_trigger;
-    
-    return hitResult;
+    // Pooled HitResult, valid until the end of this frame
+    return PhysicsPool::hit(callback.m_actor, callback.m_point, callback.m_normal, callback.m_is_trigger);
 }
 
 luabridge::LuaRef RigidbodyManager::RaycastAll(const b2Vec2& pos, const b2Vec2& dir, float dist) {
-    // Create a table to hold the results (1-indexed)
-    luabridge::LuaRef resultTable = luabridge::newTable(Component::lua_state);
+    // Pooled result table (1-indexed), valid until the end of this frame like its hits
+    luabridge::LuaRef resultTable = PhysicsPool::list();
     
     // Return empty table if conditions aren't met
     if (!has_been_initialized || dist <= 0.0f) {
+        PhysicsPool::finishList(resultTable, 0);
         return resultTable;
     }
     
@@ -398,14 +500,80 @@ luabridge::LuaRef RigidbodyManager::RaycastAll(const b2Vec2& pos, const b2Vec2&
     for (size_t i = 0; i < callback.hits.size(); i++) {
         const auto& hit = callback.hits[i];
         
-        luabridge::LuaRef hitResult = luabridge::newTable(Component::lua_state);
-        hitResult["actor"] = hit.actor;
-        hitResult["point"] = hit.point;
-        hitResult["normal"] = hit.normal;
-        hitResult["is_trigger"] = hit.is_trigger;
-        
-        resultTable[i + 1] = hitResult; // Lua tables are 1-indexed
+        resultTable[i + 1] = PhysicsPool::hit(hit.actor, hit.point, hit.normal, hit.is_trigger); // Lua tables are 1-indexed
     }
+    PhysicsPool::finishList(resultTable, static_cast<int>(callback.hits.size()));
     
     return resultTable;
 }
+
+
+Rigidbody* RigidbodyManager::rigidbodyAt(lua_State* L, int list_index, lua_Integer i) {
+    lua_rawgeti(L, list_index, i);
+    Actor* actor = nullptr;
+    if (luabridge::detail::Userdata::isInstance<Actor>(L, -1)) {
+        actor = luabridge::Stack<Actor*>::get(L, -1);
+    }
+    lua_pop(L, 1);
+    
+    return actor ? actor->rigidbody : nullptr;
+}
+
+
+// Fills Physics.GetXxx(actor_list [, out]). Passing the previous result as out reuses it,
+// so a per-frame query allocates nothing; only the first 2 * #actor_list slots are written.
+int RigidbodyManager::pushFlatArray(lua_State* L, lua_Integer count, b2Vec2 (*read)(Rigidbody*)) {
+    if (lua_istable(L, 2)) {
+        lua_settop(L, 2);
+    } else {
+        lua_settop(L, 1);
+        lua_createtable(L, static_cast<int>(count * 2), 0);
+    }
+    
+    for (lua_Integer i = 1; i <= count; i++) {
+        Rigidbody* rb = rigidbodyAt(L, 1, i);
+        b2Vec2 value = rb ? read(rb) : b2Vec2(0.0f, 0.0f);
+        
+        lua_pushnumber(L, value.x);
+        lua_rawseti(L, 2, i * 2 - 1);
+        lua_pushnumber(L, value.y);
+        lua_rawseti(L, 2, i * 2);
+    }
+    return 1;
+}
+
+
+int RigidbodyManager::GetPositions(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    return pushFlatArray(L, static_cast<lua_Integer>(lua_rawlen(L, 1)), [](Rigidbody* rb) {
+        return rb->GetPosition();
+    });
+}
+
+
+int RigidbodyManager::GetVelocities(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    return pushFlatArray(L, static_cast<lua_Integer>(lua_rawlen(L, 1)), [](Rigidbody* rb) {
+        return rb->body ? rb->body->GetLinearVelocity() : b2Vec2(0.0f, 0.0f);
+    });
+}
+
+
+int RigidbodyManager::SetVelocities(lua_State* L) {
+    luaL_checktype(L, 1, LUA_TTABLE);
+    luaL_checktype(L, 2, LUA_TTABLE);
+    
+    lua_Integer count = static_cast<lua_Integer>(lua_rawlen(L, 1));
+    for (lua_Integer i = 1; i <= count; i++) {
+        Rigidbody* rb = rigidbodyAt(L, 1, i);
+        if (rb == nullptr || rb->body == nullptr) {
+            continue;
+        }
+        
+        lua_rawgeti(L, 2, i * 2 - 1);
+        lua_rawgeti(L, 2, i * 2);
+        rb->body->SetLinearVelocity(b2Vec2(static_cast<float>(lua_tonumber(L, -2)), static_cast<float>(lua_tonumber(L, -1))));
+        lua_pop(L, 2);
+    }
+    return 0;
+}
@@ -38,6 +38,14 @@ public:
     b2Vec2 point;
     b2Vec2 normal;
     bool is_trigger = false;
+    
+    // Frame the pooled copy was handed out in, see PhysicsPool
+    int frame = -1;
+    
+    Actor* GetActor() const;
+    b2Vec2 GetPoint() const;
+    b2Vec2 GetNormal() const;
+    bool GetIsTrigger() const;
 };
 
 class Collision {
@@ -46,6 +54,27 @@ public:
     b2Vec2 point;
     b2Vec2 normal;
     b2Vec2 relative_velocity;
+    
+    int frame = -1;
+    
+    Actor* GetOther() const;
+    b2Vec2 GetPoint() const;
+    b2Vec2 GetNormal() const;
+    b2Vec2 GetRelativeVelocity() const;
+};
+
+
+// A contact callback captured during the physics step, delivered to its actor once the step finishes
+struct ContactEvent {
+    enum Kind { CollisionEnter, CollisionExit, TriggerEnter, TriggerExit };
+    
+    Actor* actor = nullptr;
+    Kind kind = CollisionEnter;
+    Collision collision;
+    size_t actor_order = 0;
+    
+    // Pooled userdata holding a copy of collision, what main state components receive
+    const luabridge::LuaRef* view = nullptr;
 };
 
 
@@ -214,6 +243,14 @@ public:
     float GetGravityScale();
     b2Vec2 GetUpDirection();
     b2Vec2 GetRightDirection();
+    
+    // Multi-return variants, these hand plain numbers to Lua instead of a Vector2 userdata
+    int GetPositionXY(lua_State* L);
+    int GetVelocityXY(lua_State* L);
+    int SetVelocityXY(lua_State* L);
+    
+    // Fast path for Rigidbody:GetPosition, skips LuaBridge's argument marshaling
+    int LuaGetPosition(lua_State* L);
 
 };
 
@@ -226,11 +263,29 @@ public:
     
     static luabridge::LuaRef Raycast(const b2Vec2& pos, const b2Vec2& dir, float dist);
     static luabridge::LuaRef RaycastAll(const b2Vec2& pos, const b2Vec2& dir, float dist);
+    
+    // Bulk access for scripts driving many bodies, values travel as one flat {x1, y1, x2, y2, ...} array
+    static int GetPositions(lua_State* L);
+    static int GetVelocities(lua_State* L);
+    static int SetVelocities(lua_State* L);
 
     static void Initialize();
     static void Step();
     
+    // Called by the contact listener, buffers while the world is stepping and delivers right away otherwise
+    static void queueContact(Actor* actor, ContactEvent::Kind kind, const Collision& collision);
+    
     static void Cleanup();
+    
+private:
+    static std::vector<ContactEvent> pending_contacts;
+    static std::vector<ContactEvent> delivering_contacts;
+    static std::unordered_map<Actor*, size_t> contact_order;
+    
+    static void deliverContacts();
+    
+    static Rigidbody* rigidbodyAt(lua_State* L, int list_index, lua_Integer i);
+    static int pushFlatArray(lua_State* L, lua_Integer count, b2Vec2 (*read)(Rigidbody*));
 
 };
 
@@ -1,6 +1,8 @@
 // Scene.cpp
 #include "Scene.hpp"
 #include "Engine.hpp"
+#include "ScriptWorkers.hpp"
+#include "StaticLayer.hpp"
 
 using namespace std;
 
@@ -23,6 +25,9 @@ Scene::~Scene(){
 
 
 void Scene::updateActors(){
+    ScriptBudget::beginFrame();
+    ScriptProfiler::beginSampling();
+    
     processActorCreation();
     
     for (auto& [id, actor] : actors) {
@@ -32,16 +37,23 @@ void Scene::updateActors(){
     for(auto& [id,  actor] : actors){
         actor->callUpdate();
     }
+    ScriptWorkers::run(actors, "OnUpdate");
     
     for(auto& [id, actor] : actors){
         actor->callLateUpdate();
     }
+    ScriptWorkers::run(actors, "OnLateUpdate");
+    
+    // Replay what worker scripts queued (logs, events, Destroy / Instantiate) in worker order
+    ScriptWorkers::sync();
     
     for (auto& [id, actor] : actors) {
         actor->processRemovedComponents();
     }
     
     processActorDestruction();
+    
+    ScriptProfiler::endSampling();
 }
 
 void SceneDB::loadScene(){
@@ -63,6 +75,7 @@ void SceneDB::loadScene(){
     
     currentScene = Scene();
     currentScene.name = next_scene;
+    StaticLayer::clear();
     
     proceed_to_next_scene = false;
     rapidjson::Document doc;
@@ -70,6 +83,15 @@ void SceneDB::loadScene(){
     EngineHelper::ReadJsonFile(scene_path, doc);
     int idcount = 1;
     
+    // Optional preload lists, so types the scene spawns later are loaded during the transition
+    if(doc.HasMember("preload_components") && doc["preload_components"].IsArray()){
+        Component::preloadComponentTypes(doc["preload_components"]);
+    }
+    
+    if(doc.HasMember("preload_templates") && doc["preload_templates"].IsArray()){
+        Template::preloadTemplates(doc["preload_templates"]);
+    }
+    
     // First add actors from the scene file
     if(doc.HasMember("actors") && doc["actors"].IsArray()){
         for(auto& actor : doc["actors"].GetArray()){
@@ -82,6 +104,7 @@ void SceneDB::loadScene(){
                 if (act.name.empty()) {
                     act.name = templateActor.name;
                 }
+                act.template_name = templateName;
                 
                 for (const auto& [key, templateComp] : templateActor.components) {
                     if (act.components.find(key) == act.components.end()) {
@@ -127,6 +150,7 @@ void SceneDB::loadScene(){
         for (auto& [key, component_ref] : actor->components) {
             actor->injectConvenienceRef(component_ref);
         }
+        ScriptWorkers::adopt(*actor);
     }
     
     for (auto& [id, actor] : currentScene.actors) {
@@ -208,6 +232,7 @@ Actor* SceneDB::Instantiate(const std::string &template_name){
     // Create a new actor
     std::shared_ptr<Actor> newActor = std::make_shared<Actor>();
     newActor->name = templateActor.name;
+    newActor->template_name = template_name;
     
     // Clone components from template
     for (const auto& [key, comp] : templateActor.components) {
@@ -221,6 +246,8 @@ Actor* SceneDB::Instantiate(const std::string &template_name){
     
     static int nextId = 10000;
     newActor->id = nextId++;
+    
+    ScriptWorkers::adopt(*newActor);
         
     currentScene.actors_to_add.push_back(newActor);
     
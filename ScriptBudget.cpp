@@ -0,0 +1,189 @@
+//
+//  ScriptBudget.cpp
+//  game_engine
+//
+//  Created by Stanley  on 4/28/25.
+//
+
+#include "ScriptBudget.hpp"
+#include "Component.hpp"
+#include <algorithm>
+#include <cstring>
+#include <sstream>
+
+using namespace std;
+
+
+void ScriptBudget::configure(const rapidjson::Value& game_config){
+    if(!game_config.HasMember("script_budget") || !game_config["script_budget"].IsObject()){
+        return;
+    }
+    
+    const rapidjson::Value& config = game_config["script_budget"];
+    enabled = true;
+    
+    if(config.HasMember("component_instructions") && config["component_instructions"].IsNumber()){
+        component_instructions = static_cast<uint64_t>(config["component_instructions"].GetDouble());
+    }
+    if(config.HasMember("component_ms") && config["component_ms"].IsNumber()){
+        component_ms = config["component_ms"].GetDouble();
+    }
+    if(config.HasMember("frame_instructions") && config["frame_instructions"].IsNumber()){
+        frame_instructions = static_cast<uint64_t>(config["frame_instructions"].GetDouble());
+    }
+    if(config.HasMember("frame_ms") && config["frame_ms"].IsNumber()){
+        frame_ms = config["frame_ms"].GetDouble();
+    }
+    if(config.HasMember("check_interval") && config["check_interval"].IsInt()){
+        check_interval = max(1, config["check_interval"].GetInt());
+    }
+    
+    if(config.HasMember("response") && config["response"].IsString()){
+        string response_name = config["response"].GetString();
+        if(response_name == "disable"){
+            response = Response::Disable;
+        }else if(response_name == "abort_frame"){
+            response = Response::AbortFrame;
+        }else if(response_name == "log"){
+            response = Response::Log;
+        }else{
+            cout << "error: unknown script_budget response " << response_name;
+            exit(0);
+        }
+    }
+}
+
+
+void ScriptBudget::attach(lua_State* L){
+    if(enabled){
+        refreshHook(L);
+    }
+}
+
+
+void ScriptBudget::refreshHook(lua_State* L){
+    int interval = enabled ? check_interval : 0;
+    
+    if(ScriptProfiler::isSampling(L)){
+        int sample_interval = ScriptProfiler::sampleInterval();
+        interval = interval > 0 ? min(interval, sample_interval) : sample_interval;
+        profiler_countdown = sample_interval;
+    }
+    
+    if(interval > 0){
+        lua_sethook(L, &ScriptBudget::hook, LUA_MASKCOUNT, interval);
+    }else{
+        lua_sethook(L, nullptr, 0, 0);
+    }
+}
+
+
+void ScriptBudget::hook(lua_State* L, lua_Debug*){
+    int instructions = lua_gethookcount(L);
+    
+    if(ScriptProfiler::isSampling(L)){
+        profiler_countdown -= instructions;
+        if(profiler_countdown <= 0){
+            profiler_countdown += ScriptProfiler::sampleInterval();
+            ScriptProfiler::sample(L);
+        }
+    }
+    
+    if(enabled){
+        check(L, instructions);
+    }
+}
+
+
+void ScriptBudget::beginFrame(){
+    if(!enabled){
+        return;
+    }
+    
+    frame_start = Clock::now();
+    frame_start_instructions = executed;
+    frame_aborted = false;
+    frame_reported = false;
+}
+
+
+void ScriptBudget::enter(const luabridge::LuaRef& component, const char* function_name, const std::string& actor_name){
+    calls.push_back({&component, function_name, &actor_name, Clock::now(), executed, false});
+}
+
+
+void ScriptBudget::leave(){
+    calls.pop_back();
+}
+
+
+bool ScriptBudget::isPerFrame(const char* function_name){
+    return strcmp(function_name, "OnUpdate") == 0 || strcmp(function_name, "OnLateUpdate") == 0;
+}
+
+
+void ScriptBudget::check(lua_State* L, int instructions){
+    executed += instructions;
+    if(calls.empty()){
+        return;
+    }
+    
+    Clock::time_point now = Clock::now();
+    Call& call = calls.back();
+    
+    uint64_t call_instructions = executed - call.start_instructions;
+    double call_ms = chrono::duration<double, milli>(now - call.start).count();
+    if((component_instructions > 0 && call_instructions > component_instructions) ||
+       (component_ms > 0.0 && call_ms > component_ms)){
+        overrun(L, call, false, call_instructions, call_ms);
+        return;
+    }
+    
+    // One-shot callbacks run to completion under the frame budget. Skipping OnStart / OnDestroy
+    // leaves components half set up or never torn down, and Box2D reports each contact begin / end
+    // only once. Their own component budget still applies.
+    if(!isPerFrame(call.function_name)){
+        return;
+    }
+    
+    uint64_t spent_instructions = executed - frame_start_instructions;
+    double spent_ms = chrono::duration<double, milli>(now - frame_start).count();
+    if((frame_instructions > 0 && spent_instructions > frame_instructions) ||
+       (frame_ms > 0.0 && spent_ms > frame_ms)){
+        overrun(L, call, true, spent_instructions, spent_ms);
+    }
+}
+
+
+void ScriptBudget::overrun(lua_State* L, Call& call, bool whole_frame, uint64_t instructions, double elapsed_ms){
+    bool& reported = whole_frame ? frame_reported : call.reported;
+    if(!reported){
+        reported = true;
+        ScriptProfiler::recordOverrun(*call.component);
+        
+        if(response == Response::Log){
+            luabridge::LuaRef type = (*call.component)["type"];
+            stringstream message;
+            message << *call.actor_name << " : " << (whole_frame ? "frame" : "component") << " script budget exceeded in "
+                    << (type.isString() ? type.cast<string>() : string("?")) << "." << call.function_name
+                    << " (" << instructions << " instructions, " << elapsed_ms << " ms)";
+            Component::reportError(message.str());
+        }
+    }
+    
+    if(response == Response::Log){
+        return;
+    }
+    
+    // Keeps raising on every check while over budget, so a script can't pcall its way past it
+    if(response == Response::Disable && !whole_frame){
+        (*call.component)["enabled"] = false;
+        luaL_error(L, "component script budget exceeded (%d instructions, %f ms), component disabled",
+                   static_cast<int>(min<uint64_t>(instructions, INT32_MAX)), elapsed_ms);
+        return;
+    }
+    
+    frame_aborted = true;
+    luaL_error(L, "%s script budget exceeded (%d instructions, %f ms), frame aborted", whole_frame ? "frame" : "component",
+               static_cast<int>(min<uint64_t>(instructions, INT32_MAX)), elapsed_ms);
+}
@@ -0,0 +1,79 @@
+//
+//  ScriptBudget.hpp
+//  game_engine
+//
+//  Created by Stanley  on 4/28/25.
+//
+
+#ifndef ScriptBudget_hpp
+#define ScriptBudget_hpp
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include "lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "rapidjson/document.h"
+
+// Watchdog for runaway component scripts. Enabled with "script_budget" in game.config:
+//   { "component_instructions": 1000000, "component_ms": 4, "frame_instructions": 5000000,
+//     "frame_ms": 12, "response": "log" | "disable" | "abort_frame", "check_interval": 1000 }
+// Budgets left out are not enforced. A count hook checks every check_interval VM instructions.
+// A component overrun gets the configured response. A frame overrun is logged, or aborts the
+// rest of the frame's OnUpdate / OnLateUpdate for disable / abort_frame, since whoever is running
+// then isn't necessarily to blame. Lifecycle and contact callbacks always run, outside the frame budget. Lua allows a single hook per state, so the same hook also drives ScriptProfiler.
+class ScriptBudget{
+public:
+    enum class Response { Log, Disable, AbortFrame };
+    
+    static inline bool enabled = false;
+    
+    static void configure(const rapidjson::Value& game_config);
+    static void attach(lua_State* L);
+    
+    // Reinstalls the count hook with the interval everyone sharing it needs
+    static void refreshHook(lua_State* L);
+    
+    // Frames are per thread, script workers start one for each phase they run
+    static void beginFrame();
+    static bool frameAborted(){ return frame_aborted; }
+    
+    static void enter(const luabridge::LuaRef& component, const char* function_name, const std::string& actor_name);
+    static void leave();
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct Call{
+        const luabridge::LuaRef* component;
+        const char* function_name;
+        const std::string* actor_name;
+        Clock::time_point start;
+        uint64_t start_instructions;
+        bool reported;
+    };
+    
+    static inline Response response = Response::Log;
+    static inline int check_interval = 1000;
+    static inline uint64_t component_instructions = 0;
+    static inline double component_ms = 0.0;
+    static inline uint64_t frame_instructions = 0;
+    static inline double frame_ms = 0.0;
+    
+    static inline thread_local std::vector<Call> calls;
+    static inline thread_local uint64_t executed = 0;
+    static inline thread_local Clock::time_point frame_start;
+    static inline thread_local uint64_t frame_start_instructions = 0;
+    static inline thread_local bool frame_aborted = false;
+    static inline thread_local bool frame_reported = false;
+    
+    static inline int profiler_countdown = 0;
+    
+    static void hook(lua_State* L, lua_Debug* ar);
+    static void check(lua_State* L, int instructions);
+    static bool isPerFrame(const char* function_name);
+    static void overrun(lua_State* L, Call& call, bool whole_frame, uint64_t instructions, double elapsed_ms);
+};
+
+#endif /* ScriptBudget_hpp */
@@ -0,0 +1,220 @@
+//
+//  ScriptProfiler.cpp
+//  game_engine
+//
+//  Created by Stanley  on 4/22/25.
+//
+
+#include "ScriptProfiler.hpp"
+#include "Actor.hpp"
+#include "ScriptBudget.hpp"
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+using namespace std;
+
+
+void ScriptProfiler::configure(const rapidjson::Value& game_config){
+    if(!game_config.HasMember("script_profiler")){
+        return;
+    }
+    
+    const rapidjson::Value& config = game_config["script_profiler"];
+    if(config.IsBool()){
+        enabled = config.GetBool();
+        return;
+    }
+    
+    if(config.IsObject()){
+        enabled = true;
+        
+        if(config.HasMember("sample_interval") && config["sample_interval"].IsInt()){
+            sample_interval = max(1, config["sample_interval"].GetInt());
+        }
+        
+        if(config.HasMember("output") && config["output"].IsString()){
+            output_path = config["output"].GetString();
+        }
+    }
+}
+
+
+void ScriptProfiler::attach(lua_State* L){
+    if(!enabled){
+        return;
+    }
+    
+    profiled_state = L;
+    original_alloc = lua_getallocf(L, &original_alloc_ud);
+    lua_setallocf(L, &ScriptProfiler::countingAlloc, nullptr);
+}
+
+
+void* ScriptProfiler::countingAlloc(void*, void* ptr, size_t osize, size_t nsize){
+    // Lua passes a null block (with osize holding the object tag) for fresh allocations
+    if(!frames.empty() && nsize > 0 && (ptr == nullptr || nsize > osize)){
+        TypeStats* stats = frames.back().stats;
+        stats->allocations++;
+        stats->allocated_bytes += ptr == nullptr ? nsize : nsize - osize;
+    }
+    
+    return original_alloc(original_alloc_ud, ptr, osize, nsize);
+}
+
+
+void ScriptProfiler::beginSampling(){
+    if(enabled){
+        sampling = true;
+        ScriptBudget::refreshHook(profiled_state);
+    }
+}
+
+
+void ScriptProfiler::endSampling(){
+    if(enabled){
+        sampling = false;
+        ScriptBudget::refreshHook(profiled_state);
+    }
+}
+
+
+int ScriptProfiler::stackDepth(lua_State* L){
+    lua_Debug ar;
+    int depth = 0;
+    while(lua_getstack(L, depth, &ar)){
+        depth++;
+    }
+    return depth;
+}
+
+
+void ScriptProfiler::enter(const luabridge::LuaRef& component, const char* function_name){
+    std::string actor_label = "<unknown>";
+    luabridge::LuaRef actor = component["actor"];
+    if(actor.isInstance<Actor>()){
+        Actor* owner = actor.cast<Actor*>();
+        actor_label = owner->template_name.empty() ? owner->name : owner->template_name;
+    }
+    
+    std::string type = "<unknown>";
+    luabridge::LuaRef type_ref = component["type"];
+    if(type_ref.isString()){
+        type = type_ref.cast<std::string>();
+    }
+    
+    Frame frame;
+    frame.context = actor_label + ";" + type + "." + function_name;
+    frame.stats = &type_stats[type];
+    frame.stats->calls++;
+    frame.base_depth = stackDepth(profiled_state);
+    frame.start = Clock::now();
+    frames.push_back(std::move(frame));
+}
+
+
+void ScriptProfiler::leave(){
+    Frame& frame = frames.back();
+    double elapsed_ms = chrono::duration<double, milli>(Clock::now() - frame.start).count();
+    
+    frame.stats->total_ms += elapsed_ms;
+    frame.stats->self_ms += elapsed_ms - frame.child_ms;
+    frames.pop_back();
+    
+    if(!frames.empty()){
+        frames.back().child_ms += elapsed_ms;
+    }
+}
+
+
+void ScriptProfiler::sample(lua_State* L){
+    if(frames.empty()){
+        folded_stacks["<engine>"]++;
+        return;
+    }
+    
+    // Enclosing dispatches (e.g. an event handler run from inside OnUpdate) form the prefix
+    std::string stack;
+    for(const auto& frame : frames){
+        if(!stack.empty()){
+            stack += ";";
+        }
+        stack += frame.context;
+    }
+    
+    // Then the Lua frames below the dispatched function, outermost first
+    int inner_frames = stackDepth(L) - frames.back().base_depth - 1;
+    lua_Debug info;
+    for(int level = inner_frames - 1; level >= 0; level--){
+        if(!lua_getstack(L, level, &info) || !lua_getinfo(L, "Sn", &info)){
+            continue;
+        }
+        stack += ";";
+        stack += info.name != nullptr ? info.name : "?";
+        stack += "@";
+        stack += info.short_src;
+        stack += ":" + to_string(info.linedefined);
+    }
+    
+    folded_stacks[stack]++;
+    frames.back().stats->samples++;
+}
+
+
+void ScriptProfiler::recordOverrun(const luabridge::LuaRef& component){
+    // Worker states overrun on their own threads, the tables here are main-thread only
+    if(!enabled || component.state() != profiled_state){
+        return;
+    }
+    
+    luabridge::LuaRef type_ref = component["type"];
+    type_stats[type_ref.isString() ? type_ref.cast<std::string>() : "<unknown>"].overruns++;
+}
+
+
+void ScriptProfiler::dump(){
+    if(!enabled){
+        return;
+    }
+    
+    filesystem::create_directories(output_path);
+    
+    // Folded stacks, one "frame;frame;frame count" line each, for flamegraph.pl / speedscope
+    ofstream folded(output_path + "/script_profile.folded");
+    for(const auto& [stack, count] : folded_stacks){
+        folded << stack << " " << count << "\n";
+    }
+    
+    vector<pair<string, TypeStats>> rows(type_stats.begin(), type_stats.end());
+    sort(rows.begin(), rows.end(), [](const auto& a, const auto& b){
+        return a.second.total_ms > b.second.total_ms;
+    });
+    
+    ofstream table(output_path + "/script_profile.txt");
+    table << left << setw(28) << "type" << right
+          << setw(10) << "calls"
+          << setw(12) << "total_ms"
+          << setw(12) << "self_ms"
+          << setw(12) << "allocs"
+          << setw(12) << "alloc_kb"
+          << setw(10) << "samples"
+          << setw(10) << "overruns" << "\n";
+    
+    table << fixed << setprecision(3);
+    for(const auto& [type, stats] : rows){
+        table << left << setw(28) << type << right
+              << setw(10) << stats.calls
+              << setw(12) << stats.total_ms
+              << setw(12) << stats.self_ms
+              << setw(12) << stats.allocations
+              << setw(12) << stats.allocated_bytes / 1024.0
+              << setw(10) << stats.samples
+              << setw(10) << stats.overruns << "\n";
+    }
+}
+
+
+int ScriptProfiler::LuaDumpProfile(lua_State*){
+    dump();
+    return 0;
+}
@@ -0,0 +1,85 @@
+//
+//  ScriptProfiler.hpp
+//  game_engine
+//
+//  Created by Stanley  on 4/22/25.
+//
+
+#ifndef ScriptProfiler_hpp
+#define ScriptProfiler_hpp
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <unordered_map>
+#include "lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "rapidjson/document.h"
+
+// Sampling profiler for component scripts.
+// Enabled with "script_profiler" in game.config, either true or
+// { "sample_interval": <vm instructions>, "output": "<directory>" }.
+// A count hook samples the Lua stack while Scene::updateActors runs, and every
+// dispatched lifecycle call is timed and charged to its component type.
+class ScriptProfiler{
+public:
+    static inline bool enabled = false;
+    
+    static void configure(const rapidjson::Value& game_config);
+    static void attach(lua_State* L);
+    
+    static void beginSampling();
+    static void endSampling();
+    
+    // Driven by ScriptBudget's count hook, which owns the single hook slot per Lua state
+    static bool isSampling(lua_State* L){ return sampling && L == profiled_state; }
+    static int sampleInterval(){ return sample_interval; }
+    static void sample(lua_State* L);
+    
+    static void recordOverrun(const luabridge::LuaRef& component);
+    
+    static void enter(const luabridge::LuaRef& component, const char* function_name);
+    static void leave();
+    
+    static void dump();
+    static int LuaDumpProfile(lua_State* L);
+    
+private:
+    using Clock = std::chrono::steady_clock;
+    
+    struct TypeStats{
+        uint64_t calls = 0;
+        double total_ms = 0.0;
+        double self_ms = 0.0;
+        uint64_t allocations = 0;
+        uint64_t allocated_bytes = 0;
+        uint64_t samples = 0;
+        uint64_t overruns = 0;
+    };
+    
+    struct Frame{
+        std::string context;
+        TypeStats* stats = nullptr;
+        Clock::time_point start;
+        double child_ms = 0.0;
+        int base_depth = 0;
+    };
+    
+    static inline lua_State* profiled_state = nullptr;
+    static inline bool sampling = false;
+    static inline lua_Alloc original_alloc = nullptr;
+    static inline void* original_alloc_ud = nullptr;
+    
+    static inline int sample_interval = 1000;
+    static inline std::string output_path = "profile";
+    
+    static inline std::vector<Frame> frames;
+    static inline std::unordered_map<std::string, TypeStats> type_stats;
+    static inline std::unordered_map<std::string, uint64_t> folded_stacks;
+    
+    static void* countingAlloc(void* ud, void* ptr, size_t osize, size_t nsize);
+    static int stackDepth(lua_State* L);
+};
+
+#endif /* ScriptProfiler_hpp */
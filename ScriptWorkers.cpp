@@ -0,0 +1,520 @@
+//
+//  ScriptWorkers.cpp
+//  game_engine
+//
+//  Created by Stanley  on 4/24/25.
+//
+
+#include "ScriptWorkers.hpp"
+#include "Engine.hpp"
+#include "FastBindings.hpp"
+#include <cstring>
+
+using namespace std;
+
+static constexpr int MAX_TRANSFER_DEPTH = 8;
+
+
+void ScriptWorkers::configure(const rapidjson::Value& game_config){
+    if(!game_config.HasMember("parallel_scripts")){
+        return;
+    }
+    
+    const rapidjson::Value& config = game_config["parallel_scripts"];
+    if(config.IsBool() && config.GetBool()){
+        int spare_cores = static_cast<int>(thread::hardware_concurrency()) - 1;
+        worker_count = max(1, min(8, spare_cores));
+    }else if(config.IsInt()){
+        worker_count = max(0, config.GetInt());
+    }
+    
+    enabled = worker_count > 0;
+}
+
+
+void ScriptWorkers::initialize(){
+    if(!enabled){
+        return;
+    }
+    
+    pool = new Pool();
+    
+    for(int i = 0; i < worker_count; i++){
+        Worker* worker = new Worker();
+        worker->index = i;
+        initializeWorkerState(*worker);
+        workers.push_back(worker);
+        
+        thread(&ScriptWorkers::workerLoop, worker).detach();
+    }
+}
+
+
+void ScriptWorkers::initializeWorkerState(Worker& worker){
+    worker.L = luaL_newstate();
+    luaL_openlibs(worker.L);
+    
+    Component::initializeSharedFunctions(worker.L);
+    ScriptBudget::attach(worker.L);
+    
+    luabridge::getGlobalNamespace(worker.L)
+        .beginNamespace("Debug")
+        .addFunction("Log", &ScriptWorkers::Log)
+        .addFunction("LogError", &ScriptWorkers::LogError)
+        .endNamespace();
+    
+    luabridge::getGlobalNamespace(worker.L)
+        .beginClass<Actor>("Actor")
+        .addFunction("GetName", &Actor::GetName)
+        .addFunction("GetID", &Actor::GetID)
+        .addFunction("GetComponent", &Actor::GetComponentLocal)
+        .endClass();
+    
+    luabridge::getGlobalNamespace(worker.L)
+        .beginNamespace("Actor")
+        .addFunction("Instantiate", &ScriptWorkers::Instantiate)
+        .addFunction("Destroy", &ScriptWorkers::Destroy)
+        .endNamespace();
+    
+    luabridge::getGlobalNamespace(worker.L)
+        .beginNamespace("Event")
+        .addFunction("Publish", &ScriptWorkers::Publish)
+        .addFunction("Subscribe", &ScriptWorkers::Subscribe)
+        .addFunction("Unsubscribe", &ScriptWorkers::Unsubscribe)
+        .endNamespace();
+    
+    // Positions are only written by RigidbodyManager::Step, so the bulk read is safe from any worker
+    luabridge::getGlobalNamespace(worker.L)
+        .beginNamespace("Physics")
+        .addFunction("GetPositions", &RigidbodyManager::GetPositions)
+        .endNamespace();
+    
+    luabridge::getGlobalNamespace(worker.L)
+        .beginNamespace("Application")
+        .addFunction("GetFrame", &FastBindings::ApplicationGetFrame)
+        .endNamespace();
+    
+    // Input state is only written between frames, so reading it from workers is safe
+    luabridge::getGlobalNamespace(worker.L)
+        .beginNamespace("Input")
+        .addFunction("Key", &FastBindings::InputKey)
+        .addFunction("GetKey", &FastBindings::InputGetKey)
+        .addFunction("GetKeyDown", &FastBindings::InputGetKeyDown)
+        .addFunction("GetKeyUp", &FastBindings::InputGetKeyUp)
+        .addFunction("GetMouseButton", &FastBindings::InputGetMouseButton)
+        .addFunction("GetMouseButtonDown", &FastBindings::InputGetMouseButtonDown)
+        .addFunction("GetMouseButtonUp", &FastBindings::InputGetMouseButtonUp)
+        .addFunction("GetMouseScrollDelta", &FastBindings::InputGetMouseScrollDelta)
+        .endNamespace();
+    
+    // Only calls that touch the body itself, SetPosition / SetRotation move broadphase proxies
+    luabridge::getGlobalNamespace(worker.L)
+        .beginClass<Rigidbody>("Rigidbody")
+        .addData("enabled", &Rigidbody::enabled, false)
+        .addData("key", &Rigidbody::key, false)
+        .addData("type", &Rigidbody::type, false)
+        .addData("actor", &Rigidbody::actor, false)
+        .addFunction("GetPosition", &Rigidbody::LuaGetPosition)
+        .addFunction("GetRotation", &Rigidbody::GetRotation)
+        .addFunction("GetVelocity", &Rigidbody::GetVelocity)
+        .addFunction("GetAngularVelocity", &Rigidbody::GetAngularVelocity)
+        .addFunction("GetGravityScale", &Rigidbody::GetGravityScale)
+        .addFunction("GetUpDirection", &Rigidbody::GetUpDirection)
+        .addFunction("GetRightDirection", &Rigidbody::GetRightDirection)
+        .addFunction("GetPositionXY", &Rigidbody::GetPositionXY)
+        .addFunction("GetVelocityXY", &Rigidbody::GetVelocityXY)
+        .addFunction("SetVelocityXY", &Rigidbody::SetVelocityXY)
+        .addFunction("AddForce", &Rigidbody::AddForce)
+        .addFunction("SetVelocity", &Rigidbody::SetVelocity)
+        .addFunction("SetAngularVelocity", &Rigidbody::SetAngularVelocity)
+        .addFunction("SetGravityScale", &Rigidbody::SetGravityScale)
+        .endClass();
+}
+
+
+bool ScriptWorkers::isParallelSafe(const std::string& type){
+    auto cached = parallel_safe_types.find(type);
+    if(cached != parallel_safe_types.end()){
+        return cached->second;
+    }
+    
+    bool parallel_safe = false;
+    auto table = Component::component_tables.find(type);
+    if(table != Component::component_tables.end()){
+        luabridge::LuaRef flag = (*table->second)["parallel_safe"];
+        parallel_safe = flag.isBool() && flag.cast<bool>();
+    }
+    
+    parallel_safe_types[type] = parallel_safe;
+    return parallel_safe;
+}
+
+
+luabridge::LuaRef& ScriptWorkers::workerComponentTable(Worker& worker, const std::string& type){
+    auto table = worker.component_tables.find(type);
+    if(table != worker.component_tables.end()){
+        return *table->second;
+    }
+    
+    if(!Component::loadComponentScript(worker.L, Component::component_paths[type])){
+        cout << "problem with lua file " << type;
+        exit(0);
+    }
+    
+    auto loaded = make_shared<luabridge::LuaRef>(luabridge::getGlobal(worker.L, type.c_str()));
+    worker.component_tables[type] = loaded;
+    return *loaded;
+}
+
+
+void ScriptWorkers::reloadComponentType(const std::string& type){
+    for(Worker* worker : workers){
+        auto table = worker->component_tables.find(type);
+        if(table != worker->component_tables.end()){
+            Component::reloadComponentType(worker->L, *table->second, type);
+        }
+    }
+}
+
+
+void ScriptWorkers::adopt(Actor& actor){
+    if(!enabled){
+        return;
+    }
+    
+    for(auto& [key, component] : actor.components){
+        if(component->state() != Component::lua_state || !component->isTable()){
+            continue;
+        }
+        
+        luabridge::LuaRef type = (*component)["type"];
+        if(!type.isString() || !isParallelSafe(type.cast<string>())){
+            continue;
+        }
+        
+        // The partition is fixed on first adoption, dont_destroy actors keep it across scene loads
+        if(actor.script_worker < 0){
+            actor.script_worker = actor.id % worker_count;
+        }
+        migrate(*workers[actor.script_worker], actor, component, type.cast<string>());
+    }
+}
+
+
+void ScriptWorkers::migrate(Worker& worker, Actor& actor, std::shared_ptr<luabridge::LuaRef>& component, const std::string& type){
+    lua_State* M = Component::lua_state;
+    lua_State* W = worker.L;
+    luabridge::LuaRef& worker_type = workerComponentTable(worker, type);
+    
+    lua_newtable(W);
+    int target = lua_gettop(W);
+    
+    Component::component_tables[type]->push(M);
+    int type_index = lua_gettop(M);
+    component->push(M);
+    
+    // Flatten the instance -> template instance -> ... chain, nearer levels win
+    while(lua_istable(M, -1) && !lua_rawequal(M, -1, type_index)){
+        lua_pushnil(M);
+        while(lua_next(M, -2)){
+            if(lua_type(M, -2) == LUA_TSTRING){
+                const char* field = lua_tostring(M, -2);
+                lua_getfield(W, target, field);
+                bool already_set = !lua_isnil(W, -1);
+                lua_pop(W, 1);
+                
+                if(!already_set && strcmp(field, "actor") != 0){
+                    transfer(M, -1, W);
+                    lua_setfield(W, target, field);
+                }
+            }
+            lua_pop(M, 1);
+        }
+        
+        if(!lua_getmetatable(M, -1)){
+            break;
+        }
+        lua_getfield(M, -1, "__index");
+        lua_remove(M, -2);
+        lua_remove(M, -2);
+    }
+    lua_settop(M, type_index - 1);
+    
+    lua_newtable(W);
+    worker_type.push(W);
+    lua_setfield(W, -2, "__index");
+    lua_setmetatable(W, target);
+    
+    luabridge::Stack<Actor*>::push(W, &actor);
+    lua_setfield(W, target, "actor");
+    
+    component = make_shared<luabridge::LuaRef>(luabridge::LuaRef::fromStack(W, target));
+    lua_settop(W, target - 1);
+}
+
+
+void ScriptWorkers::transfer(lua_State* from, int index, lua_State* to, int depth){
+    index = lua_absindex(from, index);
+    
+    switch(lua_type(from, index)){
+        case LUA_TBOOLEAN:
+            lua_pushboolean(to, lua_toboolean(from, index));
+            break;
+        case LUA_TNUMBER:
+            if(lua_isinteger(from, index)){
+                lua_pushinteger(to, lua_tointeger(from, index));
+            }else{
+                lua_pushnumber(to, lua_tonumber(from, index));
+            }
+            break;
+        case LUA_TSTRING:{
+            size_t length = 0;
+            const char* text = lua_tolstring(from, index, &length);
+            lua_pushlstring(to, text, length);
+            break;
+        }
+        case LUA_TTABLE:
+            if(depth >= MAX_TRANSFER_DEPTH){
+                lua_pushnil(to);
+                break;
+            }
+            lua_newtable(to);
+            lua_pushnil(from);
+            while(lua_next(from, index)){
+                transfer(from, -2, to, depth + 1);
+                transfer(from, -1, to, depth + 1);
+                if(lua_isnil(to, -2) || lua_isnil(to, -1)){
+                    lua_pop(to, 2);
+                }else{
+                    lua_rawset(to, -3);
+                }
+                lua_pop(from, 1);
+            }
+            break;
+        case LUA_TUSERDATA:
+            // Value types are copied, engine objects are passed by pointer
+            if(luabridge::detail::Userdata::isInstance<b2Vec2>(from, index)){
+                luabridge::Stack<b2Vec2>::push(to, luabridge::Stack<b2Vec2>::get(from, index));
+            }else if(luabridge::detail::Userdata::isInstance<Actor>(from, index)){
+                luabridge::Stack<Actor*>::push(to, luabridge::Stack<Actor*>::get(from, index));
+            }else{
+                lua_pushnil(to);
+            }
+            break;
+        default:
+            lua_pushnil(to);
+            break;
+    }
+}
+
+
+luabridge::LuaRef ScriptWorkers::transferRef(const luabridge::LuaRef& value, lua_State* to){
+    lua_State* from = value.state();
+    value.push(from);
+    transfer(from, -1, to);
+    lua_pop(from, 1);
+    
+    luabridge::LuaRef copy = luabridge::LuaRef::fromStack(to, -1);
+    lua_pop(to, 1);
+    return copy;
+}
+
+
+bool ScriptWorkers::owns(lua_State* L, const Actor* actor){
+    // Off the worker threads nothing runs concurrently, so every actor is fair game
+    if(L == Component::lua_state || current_worker == nullptr){
+        return true;
+    }
+    return actor->script_worker == current_worker->index;
+}
+
+
+void ScriptWorkers::run(const std::map<int, std::shared_ptr<Actor>>& actors, const char* phase){
+    if(!enabled){
+        return;
+    }
+    
+    for(Worker* worker : workers){
+        worker->entries.clear();
+    }
+    
+    for(const auto& [id, actor] : actors){
+        if(actor->script_worker < 0){
+            continue;
+        }
+        
+        Worker* worker = workers[actor->script_worker];
+        for(const auto& [key, component] : actor->components){
+            if(component->state() == worker->L){
+                worker->entries.emplace_back(actor.get(), component);
+            }
+        }
+    }
+    
+    {
+        lock_guard<mutex> lock(pool->mutex);
+        pool->phase = phase;
+        pool->pending = worker_count;
+        pool->generation++;
+    }
+    pool->start.notify_all();
+    
+    unique_lock<mutex> lock(pool->mutex);
+    pool->done.wait(lock, []{ return pool->pending == 0; });
+}
+
+
+void ScriptWorkers::workerLoop(Worker* worker){
+    current_worker = worker;
+    uint64_t seen_generation = 0;
+    
+    while(true){
+        const char* phase = nullptr;
+        {
+            unique_lock<mutex> lock(pool->mutex);
+            pool->start.wait(lock, [&]{ return pool->generation != seen_generation; });
+            seen_generation = pool->generation;
+            phase = pool->phase;
+        }
+        
+        ScriptBudget::beginFrame();
+        
+        bool late_update = strcmp(phase, "OnLateUpdate") == 0;
+        for(const auto& [actor, component] : worker->entries){
+            if(late_update){
+                Component::callOnLateUpdate(component, actor->name);
+            }else{
+                Component::callOnUpdate(component, actor->name);
+            }
+        }
+        Component::takeErrors(worker->errors);
+        
+        lock_guard<mutex> lock(pool->mutex);
+        if(--pool->pending == 0){
+            pool->done.notify_one();
+        }
+    }
+}
+
+
+void ScriptWorkers::sync(){
+    if(!enabled){
+        return;
+    }
+    
+    for(Worker* worker : workers){
+        Component::reportErrors(worker->errors);
+        
+        for(auto& command : worker->commands){
+            execute(command);
+        }
+        worker->commands.clear();
+    }
+}
+
+
+void ScriptWorkers::submit(Command&& command){
+    // Worker states also run on the main thread (OnStart, collisions, events), nothing to defer there
+    if(current_worker == nullptr){
+        execute(command);
+        return;
+    }
+    current_worker->commands.push_back(std::move(command));
+}
+
+
+void ScriptWorkers::execute(Command& command){
+    switch(command.kind){
+        case Command::Kind::Log:
+            Component::print(command.text);
+            break;
+        case Command::Kind::LogError:
+            Component::printError(command.text);
+            break;
+        case Command::Kind::Publish:
+            EventBus::Publish(eventId(command), transferRef(*command.first, Component::lua_state));
+            break;
+        case Command::Kind::Subscribe:
+            EventBus::Subscribe(eventId(command), *command.first, *command.second);
+            break;
+        case Command::Kind::Unsubscribe:
+            EventBus::Unsubscribe(eventId(command), *command.first, *command.second);
+            break;
+        case Command::Kind::Destroy:
+            SceneDB::Destroy(command.actor);
+            break;
+        case Command::Kind::Instantiate:
+            SceneDB::Instantiate(command.text);
+            break;
+    }
+}
+
+
+int ScriptWorkers::Log(lua_State* L){
+    submit({Command::Kind::Log, luaL_tolstring(L, 1, nullptr)});
+    return 0;
+}
+
+
+int ScriptWorkers::LogError(lua_State* L){
+    submit({Command::Kind::LogError, luaL_tolstring(L, 1, nullptr)});
+    return 0;
+}
+
+
+// Workers can't intern (StringTable is main-thread only), so names are resolved at sync
+ScriptWorkers::Command ScriptWorkers::eventCommand(lua_State* L, Command::Kind kind){
+    Command command{kind};
+    if(lua_type(L, 1) == LUA_TNUMBER){
+        command.id = static_cast<uint32_t>(lua_tointeger(L, 1));
+    }else{
+        command.text = luaL_checkstring(L, 1);
+    }
+    return command;
+}
+
+
+uint32_t ScriptWorkers::eventId(const Command& command){
+    return command.id != 0 ? command.id : StringTable::Intern(command.text);
+}
+
+
+int ScriptWorkers::Publish(lua_State* L){
+    Command command = eventCommand(L, Command::Kind::Publish);
+    command.first = luabridge::LuaRef::fromStack(L, 2);
+    submit(std::move(command));
+    return 0;
+}
+
+
+int ScriptWorkers::Subscribe(lua_State* L){
+    Command command = eventCommand(L, Command::Kind::Subscribe);
+    command.first = luabridge::LuaRef::fromStack(L, 2);
+    command.second = luabridge::LuaRef::fromStack(L, 3);
+    submit(std::move(command));
+    return 0;
+}
+
+
+int ScriptWorkers::Unsubscribe(lua_State* L){
+    Command command = eventCommand(L, Command::Kind::Unsubscribe);
+    command.first = luabridge::LuaRef::fromStack(L, 2);
+    command.second = luabridge::LuaRef::fromStack(L, 3);
+    submit(std::move(command));
+    return 0;
+}
+
+
+int ScriptWorkers::Destroy(lua_State* L){
+    Command command{Command::Kind::Destroy};
+    command.actor = luabridge::Stack<Actor*>::get(L, 1);
+    submit(std::move(command));
+    return 0;
+}
+
+
+// The new actor is only created at the sync point, so worker scripts get nil back
+int ScriptWorkers::Instantiate(lua_State* L){
+    submit({Command::Kind::Instantiate, luaL_checkstring(L, 1)});
+    return 0;
+}
@@ -0,0 +1,117 @@
+//
+//  ScriptWorkers.hpp
+//  game_engine
+//
+//  Created by Stanley  on 4/24/25.
+//
+
+#ifndef ScriptWorkers_hpp
+#define ScriptWorkers_hpp
+
+#include <map>
+#include <mutex>
+#include <thread>
+#include <memory>
+#include <string>
+#include <vector>
+#include <optional>
+#include <condition_variable>
+#include <unordered_map>
+#include "lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "rapidjson/document.h"
+
+class Actor;
+
+// Runs parallel-safe component scripts on worker threads, each with its own lua_State.
+// Turned on with "parallel_scripts" in game.config (a worker count, or true for one per spare core).
+// Component types that set parallel_safe = true are moved into a worker state when their actor
+// enters the scene, actors are partitioned between workers by id and never migrate afterwards.
+// Their OnUpdate / OnLateUpdate run on the workers after the main state's components. Worker
+// scripts get a restricted API (Debug, Vector2, Input reads, Actor lookups, body-local Rigidbody
+// calls, Event, Actor.Destroy / Instantiate), anything touching shared engine state is queued
+// and replayed on the main thread by sync(), in worker order.
+class ScriptWorkers{
+public:
+    static inline bool enabled = false;
+    
+    static void configure(const rapidjson::Value& game_config);
+    static void initialize();
+    
+    // Moves the actor's parallel-safe components into its worker's state
+    static void adopt(Actor& actor);
+    
+    static void run(const std::map<int, std::shared_ptr<Actor>>& actors, const char* phase);
+    
+    // Applies a hot reload to every worker that has the type loaded, only call between phases
+    static void reloadComponentType(const std::string& type);
+    static void sync();
+    
+    // True when the calling worker owns the actor, always true on the main state
+    static bool owns(lua_State* L, const Actor* actor);
+    
+    // Deep-copies the value at from[index] onto the top of to, unsupported values become nil
+    static void transfer(lua_State* from, int index, lua_State* to, int depth = 0);
+    static luabridge::LuaRef transferRef(const luabridge::LuaRef& value, lua_State* to);
+    
+private:
+    struct Command{
+        enum class Kind { Log, LogError, Publish, Subscribe, Unsubscribe, Destroy, Instantiate };
+        
+        Command(Kind kind, std::string text = "") : kind(kind), text(std::move(text)) {}
+        
+        Kind kind;
+        std::string text;
+        uint32_t id = 0;
+        Actor* actor = nullptr;
+        std::optional<luabridge::LuaRef> first;
+        std::optional<luabridge::LuaRef> second;
+    };
+    
+    struct Worker{
+        int index = 0;
+        lua_State* L = nullptr;
+        std::unordered_map<std::string, std::shared_ptr<luabridge::LuaRef>> component_tables;
+        std::vector<std::pair<Actor*, std::shared_ptr<luabridge::LuaRef>>> entries;
+        std::vector<Command> commands;
+        std::vector<std::string> errors;
+    };
+    
+    // Heap allocated and never freed, so detached workers never wait on a destroyed primitive at exit
+    struct Pool{
+        std::mutex mutex;
+        std::condition_variable start;
+        std::condition_variable done;
+        uint64_t generation = 0;
+        int pending = 0;
+        const char* phase = nullptr;
+    };
+    
+    static inline int worker_count = 0;
+    static inline std::vector<Worker*> workers;
+    static inline Pool* pool = nullptr;
+    static inline std::unordered_map<std::string, bool> parallel_safe_types;
+    
+    static inline thread_local Worker* current_worker = nullptr;
+    
+    static void workerLoop(Worker* worker);
+    static void initializeWorkerState(Worker& worker);
+    static bool isParallelSafe(const std::string& type);
+    static luabridge::LuaRef& workerComponentTable(Worker& worker, const std::string& type);
+    static void migrate(Worker& worker, Actor& actor, std::shared_ptr<luabridge::LuaRef>& component, const std::string& type);
+    
+    static Command eventCommand(lua_State* L, Command::Kind kind);
+    static uint32_t eventId(const Command& command);
+    static void submit(Command&& command);
+    static void execute(Command& command);
+    
+    static int Log(lua_State* L);
+    static int LogError(lua_State* L);
+    static int Publish(lua_State* L);
+    static int Subscribe(lua_State* L);
+    static int Unsubscribe(lua_State* L);
+    static int Destroy(lua_State* L);
+    static int Instantiate(lua_State* L);
+};
+
+#endif /* ScriptWorkers_hpp */
@@ -0,0 +1,347 @@
+//
+//  StaticLayer.cpp
+//  game_engine
+//
+//  Created by Stanley  on 5/3/25.
+//
+
+#include "StaticLayer.hpp"
+#include <algorithm>
+#include <cmath>
+#include "Helper.h"
+
+using namespace std;
+
+
+void StaticLayer::prepare(SDL_Renderer* renderer, std::vector<ImageRenderRequest>& scene_commands){
+    if (!enabled){
+        return;
+    }
+    
+    for (uint32_t slot : pending){
+        if (sprites[slot].alive && sprites[slot].pending){
+            sprites[slot].pending = false;
+            link(slot);
+        }
+    }
+    pending.clear();
+    
+    if (chunks.empty()){
+        return;
+    }
+    
+    int frame = Helper::GetFrameNumber();
+    float size = static_cast<float>(chunk_size);
+    
+    // Visible world pixels, a pixel of slack for the truncation in submitSprite
+    float half_w = Renderer::window_size.x / (2.0f * Renderer::zoom_factor) + 1.0f;
+    float half_h = Renderer::window_size.y / (2.0f * Renderer::zoom_factor) + 1.0f;
+    float cam_x = Renderer::current_cam_pos.x * 100.0f;
+    float cam_y = Renderer::current_cam_pos.y * 100.0f;
+    
+    for (auto& [key, chunk] : chunks){
+        auto [order, cx, cy] = key;
+        float x = cx * size;
+        float y = cy * size;
+        
+        if (x >= cam_x + half_w || x + size <= cam_x - half_w || y >= cam_y + half_h || y + size <= cam_y - half_h){
+            if (chunk.texture && frame - chunk.last_visible_frame > evict_after_frames){
+                releaseTexture(chunk);
+            }
+            continue;
+        }
+        chunk.last_visible_frame = frame;
+        
+        if (chunk.dirty || !chunk.texture){
+            rebuild(renderer, key, chunk);
+        }
+        
+        ImageRenderRequest request;
+        request.image = chunk.image_id;
+        request.x = x / 100.0f;
+        request.y = y / 100.0f;
+        request.pivot_x = 0.0f;
+        request.pivot_y = 0.0f;
+        request.sorting_order = order;
+        request.request_order = draw_order;
+        scene_commands.push_back(request);
+    }
+}
+
+
+void StaticLayer::rebuild(SDL_Renderer* renderer, const StaticChunkKey& key, StaticChunk& chunk){
+    if (!chunk.texture){
+        chunk.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, chunk_size, chunk_size);
+        if (!chunk.texture){
+            cout << "error: could not create static layer chunk " << SDL_GetError();
+            exit(0);
+        }
+        
+        // Chunk contents are premultiplied, see Renderer::renderToTarget
+        SDL_BlendMode premultiplied = SDL_ComposeCustomBlendMode(SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+                                                                 SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+        if (SDL_SetTextureBlendMode(chunk.texture, premultiplied) != 0){
+            SDL_SetTextureBlendMode(chunk.texture, SDL_BLENDMODE_BLEND);
+        }
+        
+        ImageEntry entry;
+        entry.texture = chunk.texture;
+        entry.src = {0, 0, chunk_size, chunk_size};
+        entry.texture_w = chunk_size;
+        entry.texture_h = chunk_size;
+        entry.in_atlas = true;  // owned here, not by ImageDB
+        ImageDB::setImage(chunk.image_id, entry);
+    }
+    
+    // Static sprites overlap in the order they were added
+    sort(chunk.sprites.begin(), chunk.sprites.end(), [](uint32_t a, uint32_t b){
+        return sprites[a].sequence < sprites[b].sequence;
+    });
+    
+    build_requests.clear();
+    for (uint32_t slot : chunk.sprites){
+        build_requests.push_back(sprites[slot].request);
+    }
+    
+    auto [order, cx, cy] = key;
+    glm::vec2 origin(cx * chunk_size / 100.0f, cy * chunk_size / 100.0f);
+    Renderer::renderToTarget(chunk.texture, origin, build_requests);
+    
+    chunk.dirty = false;
+}
+
+
+void StaticLayer::releaseTexture(StaticChunk& chunk){
+    if (!chunk.texture){
+        return;
+    }
+    SDL_DestroyTexture(chunk.texture);
+    chunk.texture = nullptr;
+    chunk.dirty = true;
+    ImageDB::setImage(chunk.image_id, ImageEntry());
+}
+
+
+void StaticLayer::clear(){
+    for (auto& [key, chunk] : chunks){
+        releaseTexture(chunk);
+    }
+    chunks.clear();
+    sprites.clear();
+    free_slots.clear();
+    pending.clear();
+    epoch++;
+}
+
+
+void StaticLayer::invalidate(){
+    for (auto& [key, chunk] : chunks){
+        chunk.dirty = true;
+    }
+}
+
+
+// Chunk placement needs image sizes, so sprites added during the initial scene's OnStart wait for the renderer
+void StaticLayer::place(uint32_t slot){
+    if (!Renderer::getRenderer()){
+        if (!sprites[slot].pending){
+            sprites[slot].pending = true;
+            pending.push_back(slot);
+        }
+        return;
+    }
+    link(slot);
+}
+
+
+// Every chunk the sprite's rotated bounds touch, in world pixels
+void StaticLayer::link(uint32_t slot){
+    StaticSprite& sprite = sprites[slot];
+    const ImageRenderRequest& request = sprite.request;
+    const ImageEntry& image = ImageDB::loadImage(Renderer::getRenderer(), request.image);
+    
+    float width = image.src.w * std::abs(request.scale_x);
+    float height = image.src.h * std::abs(request.scale_y);
+    float left = -request.pivot_x * image.src.w * request.scale_x;
+    float top = -request.pivot_y * image.src.h * request.scale_y;
+    
+    float radians = request.rotation * (static_cast<float>(M_PI) / 180.0f);
+    float c = std::cos(radians);
+    float s = std::sin(radians);
+    
+    float min_x = INFINITY, min_y = INFINITY, max_x = -INFINITY, max_y = -INFINITY;
+    const float corners[4][2] = {{left, top}, {left + width, top}, {left + width, top + height}, {left, top + height}};
+    for (const auto& corner : corners){
+        float x = corner[0] * c - corner[1] * s;
+        float y = corner[0] * s + corner[1] * c;
+        min_x = std::min(min_x, x);
+        max_x = std::max(max_x, x);
+        min_y = std::min(min_y, y);
+        max_y = std::max(max_y, y);
+    }
+    
+    float size = static_cast<float>(chunk_size);
+    int cx0 = static_cast<int>(std::floor((request.x * 100.0f + min_x - 1.0f) / size));
+    int cx1 = static_cast<int>(std::floor((request.x * 100.0f + max_x + 1.0f) / size));
+    int cy0 = static_cast<int>(std::floor((request.y * 100.0f + min_y - 1.0f) / size));
+    int cy1 = static_cast<int>(std::floor((request.y * 100.0f + max_y + 1.0f) / size));
+    
+    for (int cy = cy0; cy <= cy1; cy++){
+        for (int cx = cx0; cx <= cx1; cx++){
+            StaticChunkKey key = {request.sorting_order, cx, cy};
+            auto found = chunks.find(key);
+            if (found == chunks.end()){
+                found = chunks.emplace(key, StaticChunk()).first;
+                found->second.image_id = StringTable::Intern("__static/" + to_string(request.sorting_order) + "/" + to_string(cx) + "/" + to_string(cy));
+            }
+            found->second.sprites.push_back(slot);
+            found->second.dirty = true;
+            sprite.chunks.push_back(key);
+        }
+    }
+}
+
+
+void StaticLayer::unlink(uint32_t slot){
+    StaticSprite& sprite = sprites[slot];
+    for (const StaticChunkKey& key : sprite.chunks){
+        auto found = chunks.find(key);
+        if (found == chunks.end()){
+            continue;
+        }
+        
+        StaticChunk& chunk = found->second;
+        chunk.sprites.erase(std::remove(chunk.sprites.begin(), chunk.sprites.end(), slot), chunk.sprites.end());
+        chunk.dirty = true;
+        
+        if (chunk.sprites.empty()){
+            releaseTexture(chunk);
+            chunks.erase(found);
+        }
+    }
+    sprite.chunks.clear();
+}
+
+
+ImageRenderRequest StaticLayer::readRequest(lua_State* L, int first){
+    ImageRenderRequest request;
+    request.image = StringTable::FromLua(L, first);
+    request.x = static_cast<float>(luaL_checknumber(L, first + 1));
+    request.y = static_cast<float>(luaL_checknumber(L, first + 2));
+    request.rotation = static_cast<int>(luaL_optnumber(L, first + 3, 0.0));
+    request.scale_x = static_cast<float>(luaL_optnumber(L, first + 4, 1.0));
+    request.scale_y = static_cast<float>(luaL_optnumber(L, first + 5, 1.0));
+    request.pivot_x = static_cast<float>(luaL_optnumber(L, first + 6, 0.5));
+    request.pivot_y = static_cast<float>(luaL_optnumber(L, first + 7, 0.5));
+    request.color.r = static_cast<Uint8>(luaL_optnumber(L, first + 8, 255.0));
+    request.color.g = static_cast<Uint8>(luaL_optnumber(L, first + 9, 255.0));
+    request.color.b = static_cast<Uint8>(luaL_optnumber(L, first + 10, 255.0));
+    request.color.a = static_cast<Uint8>(luaL_optnumber(L, first + 11, 255.0));
+    request.sorting_order = static_cast<int>(luaL_optnumber(L, first + 12, 0.0));
+    return request;
+}
+
+
+// Ids are (generation << 32 | slot). Generations never repeat, so a removed or cleared id stays stale
+StaticSprite* StaticLayer::fromId(uint64_t id){
+    uint32_t slot = static_cast<uint32_t>(id & 0xFFFFFFFFu);
+    uint32_t generation = static_cast<uint32_t>(id >> 32);
+    
+    if (slot >= sprites.size() || !sprites[slot].alive || sprites[slot].generation != generation){
+        return nullptr;
+    }
+    return &sprites[slot];
+}
+
+
+uint64_t StaticLayer::add(const ImageRenderRequest& request){
+    if (!enabled){
+        return 0;
+    }
+    
+    uint32_t slot;
+    if (!free_slots.empty()){
+        slot = free_slots.back();
+        free_slots.pop_back();
+    }else{
+        slot = static_cast<uint32_t>(sprites.size());
+        sprites.emplace_back();
+    }
+    
+    StaticSprite& sprite = sprites[slot];
+    sprite.request = request;
+    sprite.generation = next_generation++;
+    sprite.sequence = next_sequence++;
+    sprite.alive = true;
+    sprite.pending = false;
+    place(slot);
+    
+    return (static_cast<uint64_t>(sprite.generation) << 32) | slot;
+}
+
+
+bool StaticLayer::update(uint64_t id, const ImageRenderRequest& request){
+    StaticSprite* sprite = fromId(id);
+    if (!sprite){
+        return false;
+    }
+    
+    const ImageRenderRequest& old = sprite->request;
+    bool same = request.image == old.image && request.x == old.x && request.y == old.y && request.rotation == old.rotation
+        && request.scale_x == old.scale_x && request.scale_y == old.scale_y && request.pivot_x == old.pivot_x && request.pivot_y == old.pivot_y
+        && request.color.r == old.color.r && request.color.g == old.color.g && request.color.b == old.color.b && request.color.a == old.color.a
+        && request.sorting_order == old.sorting_order;
+    
+    if (!same){
+        uint32_t slot = static_cast<uint32_t>(sprite - sprites.data());
+        unlink(slot);
+        sprite->request = request;
+        place(slot);
+    }
+    return true;
+}
+
+
+void StaticLayer::remove(uint64_t id){
+    StaticSprite* sprite = fromId(id);
+    if (!sprite){
+        return;
+    }
+    
+    uint32_t slot = static_cast<uint32_t>(sprite - sprites.data());
+    unlink(slot);
+    sprite->alive = false;
+    sprite->pending = false;
+    free_slots.push_back(slot);
+}
+
+
+int StaticLayer::LuaAdd(lua_State* L){
+    uint64_t id = add(readRequest(L, 1));
+    if (id == 0){
+        return 0;
+    }
+    lua_pushinteger(L, static_cast<lua_Integer>(id));
+    return 1;
+}
+
+
+int StaticLayer::LuaUpdate(lua_State* L){
+    uint64_t id = lua_type(L, 1) == LUA_TNUMBER ? static_cast<uint64_t>(lua_tointeger(L, 1)) : 0;
+    lua_pushboolean(L, update(id, readRequest(L, 2)));
+    return 1;
+}
+
+
+int StaticLayer::LuaRemove(lua_State* L){
+    if (lua_type(L, 1) == LUA_TNUMBER){
+        remove(static_cast<uint64_t>(lua_tointeger(L, 1)));
+    }
+    return 0;
+}
+
+
+int StaticLayer::LuaGetEpoch(lua_State* L){
+    lua_pushinteger(L, epoch);
+    return 1;
+}
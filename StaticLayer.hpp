@@ -0,0 +1,103 @@
+//
+//  StaticLayer.hpp
+//  game_engine
+//
+//  Created by Stanley  on 5/3/25.
+//
+
+#ifndef StaticLayer_hpp
+#define StaticLayer_hpp
+
+#include <climits>
+#include <map>
+#include <tuple>
+#include <vector>
+#include "lua/lua.hpp"
+#include "Renderer.hpp"
+
+// (sorting_order, chunk x, chunk y)
+using StaticChunkKey = std::tuple<int, int, int>;
+
+
+struct StaticSprite {
+    ImageRenderRequest request;
+    uint32_t generation = 0;
+    uint64_t sequence = 0;
+    bool alive = false;
+    
+    // Added before the renderer existed, placed into chunks by the first prepare()
+    bool pending = false;
+    std::vector<StaticChunkKey> chunks;
+};
+
+
+struct StaticChunk {
+    SDL_Texture* texture = nullptr;
+    uint32_t image_id = 0;
+    bool dirty = true;
+    int last_visible_frame = 0;
+    std::vector<uint32_t> sprites;
+};
+
+
+// Sprites that never move (level tiles, backdrops) rendered once into chunk_size square render
+// targets, then composited with one draw per visible chunk. Chunks are per sorting_order so static
+// sprites keep their layering against dynamic ones, drawing first within the same order. A chunk
+// is only re-rendered when one of its sprites changes, and gives its texture back after sitting
+// off screen for evict_after_frames. "static_layer" and "static_chunk_size" in rendering.config,
+// off under RENDERLOGGER / AUTOGRADER where Image.AddStatic returns nil.
+class StaticLayer{
+public:
+    static inline bool enabled = true;
+    static inline int chunk_size = 512;
+    static inline int evict_after_frames = 120;
+    
+    // request_order of chunk draws, below Draw's 0 and every DrawEx
+    static constexpr int draw_order = INT_MIN;
+    
+    // Called at the top of Renderer::render(), queues one scene request per visible chunk
+    static void prepare(SDL_Renderer* renderer, std::vector<ImageRenderRequest>& scene_commands);
+    
+    // Drops every static sprite, on scene load. Ids handed out before report stale.
+    static void clear();
+    
+    // Render targets lost their contents (SDL_RENDER_TARGETS_RESET)
+    static void invalidate();
+    
+    // Native side of the Lua calls below. add returns 0 while the layer is off, update false once
+    // the id is stale (removed, or dropped by a scene load)
+    static uint64_t add(const ImageRenderRequest& request);
+    static bool update(uint64_t id, const ImageRenderRequest& request);
+    static void remove(uint64_t id);
+    static int getEpoch(){ return epoch; }
+    
+    // Image.AddStatic(image, x, y, rotation, scale_x, scale_y, pivot_x, pivot_y, r, g, b, a, sorting_order)
+    static int LuaAdd(lua_State* L);
+    // Image.UpdateStatic(id, <same as AddStatic>), false once the id is stale
+    static int LuaUpdate(lua_State* L);
+    static int LuaRemove(lua_State* L);
+    // Image.GetStaticEpoch(), changes whenever clear() drops the layer
+    static int LuaGetEpoch(lua_State* L);
+    
+private:
+    static inline std::vector<StaticSprite> sprites;
+    static inline std::vector<uint32_t> free_slots;
+    static inline std::map<StaticChunkKey, StaticChunk> chunks;
+    static inline std::vector<uint32_t> pending;
+    
+    static inline uint32_t next_generation = 1;
+    static inline uint64_t next_sequence = 0;
+    static inline int epoch = 1;
+    
+    static inline std::vector<ImageRenderRequest> build_requests;
+    
+    static ImageRenderRequest readRequest(lua_State* L, int first);
+    static StaticSprite* fromId(uint64_t id);
+    static void place(uint32_t slot);
+    static void link(uint32_t slot);
+    static void unlink(uint32_t slot);
+    static void rebuild(SDL_Renderer* renderer, const StaticChunkKey& key, StaticChunk& chunk);
+    static void releaseTexture(StaticChunk& chunk);
+};
+
+#endif /* StaticLayer_hpp */
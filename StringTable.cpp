@@ -0,0 +1,48 @@
+//
+//  StringTable.cpp
+//  game_engine
+//
+//  Created by Stanley  on 4/26/25.
+//
+
+#include "StringTable.hpp"
+
+using namespace std;
+
+
+uint32_t StringTable::Intern(std::string_view str){
+    auto found = ids.find(str);
+    if(found != ids.end()){
+        return found->second;
+    }
+    
+    uint32_t id = static_cast<uint32_t>(strings.size());
+    strings.emplace_back(str);
+    ids.emplace(strings.back(), id);
+    return id;
+}
+
+
+const std::string& StringTable::Get(uint32_t id){
+    if(id >= strings.size()){
+        return strings.front();
+    }
+    return strings[id];
+}
+
+
+uint32_t StringTable::FromLua(lua_State* L, int index){
+    if(lua_type(L, index) == LUA_TNUMBER){
+        return static_cast<uint32_t>(lua_tointeger(L, index));
+    }
+    
+    size_t length = 0;
+    const char* str = lua_tolstring(L, index, &length);
+    return str ? Intern(std::string_view(str, length)) : 0;
+}
+
+
+int StringTable::LuaIntern(lua_State* L){
+    lua_pushinteger(L, FromLua(L, 1));
+    return 1;
+}
@@ -0,0 +1,38 @@
+//
+//  StringTable.hpp
+//  game_engine
+//
+//  Created by Stanley  on 4/26/25.
+//
+
+#ifndef StringTable_hpp
+#define StringTable_hpp
+
+#include <deque>
+#include <string>
+#include <cstdint>
+#include <string_view>
+#include <unordered_map>
+#include "lua/lua.hpp"
+
+// Global string interner. Image, font and event names are resolved to stable 32-bit ids once,
+// engine structures then store and compare ids instead of hashing and copying std::strings.
+// Id 0 is always the empty string. Not thread-safe, only the main thread interns.
+class StringTable{
+public:
+    static uint32_t Intern(std::string_view str);
+    static const std::string& Get(uint32_t id);
+    
+    // Reads a name argument from Lua, either a pre-resolved id (number) or a string to intern
+    static uint32_t FromLua(lua_State* L, int index);
+    
+    // Image.Handle / Event.Id, hand the id to scripts so hot calls skip the lookup entirely
+    static int LuaIntern(lua_State* L);
+    
+private:
+    // deque keeps every stored string at a fixed address, so the index can key on views into it
+    static inline std::deque<std::string> strings = { "" };
+    static inline std::unordered_map<std::string_view, uint32_t> ids = { { strings.front(), 0 } };
+};
+
+#endif /* StringTable_hpp */
@@ -0,0 +1,87 @@
+//
+//  TextCache.cpp
+//  game_engine
+//
+//  Created by Stanley  on 5/1/25.
+//
+
+#include "TextCache.hpp"
+#include "Helper.h"
+
+using namespace std;
+
+
+const CachedText* TextCache::get(SDL_Renderer* renderer, TTF_Font* font, uint32_t font_id, int size, SDL_Color color, std::string_view text, bool only_repeated){
+    key.clear();
+    key.append(reinterpret_cast<const char*>(&font_id), sizeof(font_id));
+    key.append(reinterpret_cast<const char*>(&size), sizeof(size));
+    key.append(reinterpret_cast<const char*>(&color), sizeof(color));
+    key.append(text);
+    
+    auto found = entries.find(key);
+    if (found != entries.end()){
+        CachedText& entry = found->second;
+        entry.last_used_frame = Helper::GetFrameNumber();
+        lru.splice(lru.begin(), lru, entry.lru);
+        return &entry;
+    }
+    
+    if (only_repeated && seen_last_frame.find(key) == seen_last_frame.end()){
+        seen_this_frame.insert(key);
+        return nullptr;
+    }
+    
+    SDL_Surface* surface = TTF_RenderText_Solid(font, key.c_str() + key.size() - text.size(), color);
+    if (!surface){
+        return nullptr;
+    }
+    
+    CachedText entry;
+    entry.texture = SDL_CreateTextureFromSurface(renderer, surface);
+    entry.width = surface->w;
+    entry.height = surface->h;
+    entry.bytes = static_cast<size_t>(surface->w) * surface->h * 4;
+    entry.last_used_frame = Helper::GetFrameNumber();
+    SDL_FreeSurface(surface);
+    
+    auto [inserted, _] = entries.emplace(key, entry);
+    lru.push_front(&inserted->first);
+    inserted->second.lru = lru.begin();
+    used_bytes += entry.bytes;
+    
+    return &inserted->second;
+}
+
+
+void TextCache::endFrame(){
+    seen_last_frame.swap(seen_this_frame);
+    seen_this_frame.clear();
+    
+    int evicted = 0;
+    
+    while (used_bytes > budget_bytes && !lru.empty() && evicted < evictions_per_frame){
+        auto oldest = entries.find(*lru.back());
+        if (oldest->second.last_used_frame == Helper::GetFrameNumber()){
+            // Everything left is in use this frame, stay over budget until it isn't
+            break;
+        }
+        
+        SDL_DestroyTexture(oldest->second.texture);
+        used_bytes -= oldest->second.bytes;
+        lru.pop_back();
+        entries.erase(oldest);
+        evicted++;
+    }
+}
+
+
+void TextCache::clear(){
+    for (auto& [text_key, entry] : entries){
+        SDL_DestroyTexture(entry.texture);
+    }
+    entries.clear();
+    lru.clear();
+    seen_last_frame.clear();
+    seen_this_frame.clear();
+    used_bytes = 0;
+}
@@ -0,0 +1,63 @@
+//
+//  TextCache.hpp
+//  game_engine
+//
+//  Created by Stanley  on 5/1/25.
+//
+
+#ifndef TextCache_hpp
+#define TextCache_hpp
+
+#include <string>
+#include <string_view>
+#include <list>
+#include <unordered_map>
+#include <unordered_set>
+#include "SDL/SDL.h"
+#include "SDL_ttf/SDL_ttf.h"
+
+struct CachedText {
+    SDL_Texture* texture = nullptr;
+    int width = 0;
+    int height = 0;
+    size_t bytes = 0;
+    int last_used_frame = -1;
+    std::list<const std::string*>::iterator lru;
+};
+
+
+// Rendered Text.Draw strings keyed by (font, size, color, text), least recently used first out.
+// Eviction happens at the end of the frame, at most evictions_per_frame entries at a time so a
+// burst of new strings can't stall one frame, and never touches text drawn this frame. Budget
+// and limit come from "text_cache_bytes" / "text_cache_evictions_per_frame" in rendering.config.
+class TextCache{
+public:
+    static inline size_t budget_bytes = 8 * 1024 * 1024;
+    static inline int evictions_per_frame = 16;
+    
+    // nullptr when there is nothing to draw (empty string). With only_repeated a missing string is
+    // rasterized only if it was also drawn last frame, otherwise it's noted and nullptr returned,
+    // which lets strings that change every frame stay on the GlyphAtlas path.
+    static const CachedText* get(SDL_Renderer* renderer, TTF_Font* font, uint32_t font_id, int size, SDL_Color color, std::string_view text, bool only_repeated = false);
+    
+    static void endFrame();
+    static void clear();
+    
+    static size_t usedBytes(){ return used_bytes; }
+    
+private:
+    static inline std::unordered_map<std::string, CachedText> entries;
+    
+    // Front is the most recently used, the pointers are the keys of entries (stable node storage)
+    static inline std::list<const std::string*> lru;
+    
+    static inline size_t used_bytes = 0;
+    
+    static inline std::unordered_set<std::string> seen_last_frame;
+    static inline std::unordered_set<std::string> seen_this_frame;
+    
+    // Reused for lookups so hits don't build a new std::string
+    static inline std::string key;
+};
+
+#endif /* TextCache_hpp */
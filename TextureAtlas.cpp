@@ -0,0 +1,186 @@
+//
+//  TextureAtlas.cpp
+//  game_engine
+//
+//  Created by Stanley  on 4/30/25.
+//
+
+#include "TextureAtlas.hpp"
+#include <climits>
+#include <algorithm>
+
+using namespace std;
+
+
+int AtlasPage::fit(size_t index, int w, int h) const {
+    int x = skyline[index].x;
+    if (x + w > size){
+        return -1;
+    }
+    
+    // The image rests on the highest segment it spans
+    int y = skyline[index].y;
+    int width_left = w;
+    while (width_left > 0){
+        y = max(y, skyline[index].y);
+        if (y + h > size){
+            return -1;
+        }
+        width_left -= skyline[index].width;
+        index++;
+    }
+    return y;
+}
+
+
+bool AtlasPage::insert(int w, int h, SDL_Rect& out){
+    int best_bottom = INT_MAX;
+    int best_width = INT_MAX;
+    size_t best_index = skyline.size();
+    
+    for (size_t i = 0; i < skyline.size(); i++){
+        int y = fit(i, w, h);
+        if (y < 0){
+            continue;
+        }
+        if (y + h < best_bottom || (y + h == best_bottom && skyline[i].width < best_width)){
+            best_bottom = y + h;
+            best_width = skyline[i].width;
+            best_index = i;
+            out = {skyline[i].x, y, w, h};
+        }
+    }
+    
+    if (best_index == skyline.size()){
+        return false;
+    }
+    
+    skyline.insert(skyline.begin() + best_index, SkylineNode{out.x, out.y + h, w});
+    
+    // Trim the segments the new one now covers
+    for (size_t i = best_index + 1; i < skyline.size(); i++){
+        const SkylineNode& previous = skyline[i - 1];
+        int overlap = previous.x + previous.width - skyline[i].x;
+        if (overlap <= 0){
+            break;
+        }
+        
+        skyline[i].x += overlap;
+        skyline[i].width -= overlap;
+        if (skyline[i].width > 0){
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+        i--;
+    }
+    
+    // Merge neighbours left at the same height
+    for (size_t i = 0; i + 1 < skyline.size();){
+        if (skyline[i].y == skyline[i + 1].y){
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        } else {
+            i++;
+        }
+    }
+    
+    used_pixels += static_cast<long long>(w) * h;
+    images++;
+    return true;
+}
+
+
+AtlasPage TextureAtlas::createPage(SDL_Renderer* renderer, int size){
+    AtlasPage page;
+    page.texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STATIC, size, size);
+    if (!page.texture){
+        return page;
+    }
+    SDL_SetTextureBlendMode(page.texture, SDL_BLENDMODE_BLEND);
+    
+    // Static textures start undefined, the padding has to read as transparent
+    vector<Uint32> zeroes(static_cast<size_t>(size) * size, 0);
+    SDL_UpdateTexture(page.texture, nullptr, zeroes.data(), size * static_cast<int>(sizeof(Uint32)));
+    
+    page.size = size;
+    page.skyline.push_back(SkylineNode{0, 0, size});
+    return page;
+}
+
+
+bool TextureAtlas::pack(SDL_Renderer* renderer, SDL_Surface* surface, SDL_Texture*& texture, SDL_Rect& rect){
+    if (!enabled){
+        return false;
+    }
+    
+    if (pages.empty()){
+        SDL_RendererInfo info;
+        if (SDL_GetRendererInfo(renderer, &info) == 0 && info.max_texture_width > 0 && info.max_texture_height > 0){
+            page_size = min(page_size, min(info.max_texture_width, info.max_texture_height));
+        }
+    }
+    
+    int padded_w = surface->w + 2;
+    int padded_h = surface->h + 2;
+    if (padded_w > page_size || padded_h > page_size){
+        return false;
+    }
+    
+    SDL_Rect slot;
+    AtlasPage* target = nullptr;
+    for (AtlasPage& page : pages){
+        if (page.insert(padded_w, padded_h, slot)){
+            target = &page;
+            break;
+        }
+    }
+    
+    if (!target){
+        AtlasPage page = createPage(renderer, page_size);
+        if (!page.texture){
+            return false;
+        }
+        pages.push_back(page);
+        target = &pages.back();
+        if (!target->insert(padded_w, padded_h, slot)){
+            return false;
+        }
+    }
+    
+    rect = {slot.x + 1, slot.y + 1, surface->w, surface->h};
+    
+    SDL_LockSurface(surface);
+    SDL_UpdateTexture(target->texture, &rect, surface->pixels, surface->pitch);
+    SDL_UnlockSurface(surface);
+    
+    texture = target->texture;
+    return true;
+}
+
+
+void TextureAtlas::clear(){
+    for (AtlasPage& page : pages){
+        SDL_DestroyTexture(page.texture);
+    }
+    pages.clear();
+}
+
+
+int TextureAtlas::LuaGetReport(lua_State* L){
+    lua_createtable(L, static_cast<int>(pages.size()), 0);
+    
+    for (size_t i = 0; i < pages.size(); i++){
+        const AtlasPage& page = pages[i];
+        double area = static_cast<double>(page.size) * page.size;
+        
+        lua_createtable(L, 0, 3);
+        lua_pushinteger(L, page.size);
+        lua_setfield(L, -2, "size");
+        lua_pushinteger(L, page.images);
+        lua_setfield(L, -2, "images");
+        lua_pushnumber(L, page.used_pixels / area);
+        lua_setfield(L, -2, "occupancy");
+        lua_rawseti(L, -2, static_cast<lua_Integer>(i + 1));
+    }
+    return 1;
+}
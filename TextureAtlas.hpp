@@ -0,0 +1,70 @@
+//
+//  TextureAtlas.hpp
+//  game_engine
+//
+//  Created by Stanley  on 4/30/25.
+//
+
+#ifndef TextureAtlas_hpp
+#define TextureAtlas_hpp
+
+#include <vector>
+#include "SDL/SDL.h"
+#include "lua/lua.hpp"
+
+// Where an image lives: its own texture, or a sub-rect of a TextureAtlas page
+struct ImageEntry {
+    SDL_Texture* texture = nullptr;
+    SDL_Rect src = {0, 0, 0, 0};
+    int texture_w = 0;
+    int texture_h = 0;
+    bool in_atlas = false;
+};
+
+
+struct SkylineNode {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+};
+
+
+struct AtlasPage {
+    SDL_Texture* texture = nullptr;
+    int size = 0;
+    std::vector<SkylineNode> skyline;
+    
+    long long used_pixels = 0;
+    int images = 0;
+    
+    // Bottom-left skyline placement, false when the page has no room left for w x h
+    bool insert(int w, int h, SDL_Rect& out);
+    
+private:
+    int fit(size_t index, int w, int h) const;
+};
+
+
+// Packs loaded images into a few large pages so consecutive sprites mostly share one texture
+// and the sprite batch can keep going. Images keep a 1px transparent border so neighbours never
+// bleed in. Controlled by "texture_atlas" and "atlas_page_size" in rendering.config.
+class TextureAtlas{
+public:
+    static inline bool enabled = true;
+    static inline int page_size = 2048;
+    
+    // surface must be SDL_PIXELFORMAT_ARGB8888. Returns false when the image can't go in a page
+    static bool pack(SDL_Renderer* renderer, SDL_Surface* surface, SDL_Texture*& texture, SDL_Rect& rect);
+    static void clear();
+    
+    // Image.GetAtlasReport(), one {size, images, occupancy} entry per page
+    static int LuaGetReport(lua_State* L);
+    
+    // An empty, fully transparent page, also used by GlyphAtlas for its own pages
+    static AtlasPage createPage(SDL_Renderer* renderer, int size);
+    
+private:
+    static inline std::vector<AtlasPage> pages;
+};
+
+#endif /* TextureAtlas_hpp */
@@ -0,0 +1,410 @@
+//
+//  Tilemap.cpp
+//  game_engine
+//
+//  Created by Stanley  on 5/4/25.
+//
+
+#include "Tilemap.hpp"
+#include <array>
+#include "EngineHelper.hpp"
+#include "Rigidbody.hpp"
+
+using namespace std;
+
+
+void Tilemap::OnStart(){
+    if(!map.empty()){
+        loadMap();
+    }
+    
+    // Tile scales come from image sizes, a tilemap in the initial scene syncs on its first update
+    if(StaticLayer::enabled && Renderer::getRenderer()){
+        syncSprites();
+    }
+    buildColliders();
+}
+
+
+// Runs while disabled too (see Component::callOnUpdate), static sprites would otherwise keep drawing
+void Tilemap::OnUpdate(){
+    if(!enabled){
+        if(sprites_registered){
+            removeSprites();
+            sprites_dirty = true;
+        }
+        return;
+    }
+    
+    // Started disabled, OnStart was skipped
+    if(!onStart_called){
+        onStart_called = true;
+        OnStart();
+    }
+    
+    if(StaticLayer::enabled){
+        // A scene load drops the layer, a preserved tilemap adds itself back
+        if(sprites_dirty || static_epoch != StaticLayer::getEpoch()){
+            syncSprites();
+        }
+    }else{
+        drawTiles();
+    }
+    
+    if(colliders_dirty){
+        buildColliders();
+    }
+}
+
+
+void Tilemap::OnDestroy(){
+    removeSprites();
+    
+    if(body && RigidbodyManager::physics_world){
+        RigidbodyManager::physics_world->DestroyBody(body);
+    }
+    body = nullptr;
+}
+
+
+void Tilemap::loadMap(){
+    string path = "resources/tilemaps/" + map + ".json";
+    if(!filesystem::exists(path)){
+        cout << "error: tilemap " << map << " is missing";
+        exit(0);
+    }
+    
+    rapidjson::Document doc;
+    EngineHelper::ReadJsonFile(path, doc);
+    
+    if(doc.HasMember("images") && doc["images"].IsObject()){
+        for(auto it = doc["images"].MemberBegin(); it != doc["images"].MemberEnd(); ++it){
+            if(it->value.IsString()){
+                SetTileImage(atoi(it->name.GetString()), it->value.GetString());
+            }
+        }
+    }
+    
+    if(doc.HasMember("solid") && doc["solid"].IsArray()){
+        for(auto& code : doc["solid"].GetArray()){
+            if(code.IsInt()){
+                SetSolid(code.GetInt(), true);
+            }
+        }
+    }
+    
+    if(doc.HasMember("tiles") && doc["tiles"].IsArray()){
+        const auto& rows = doc["tiles"].GetArray();
+        int new_width = 0;
+        for(auto& row : rows){
+            if(row.IsArray()){
+                new_width = max(new_width, static_cast<int>(row.Size()));
+            }
+        }
+        resize(new_width, static_cast<int>(rows.Size()));
+        
+        for(int r = 0; r < height; r++){
+            if(!rows[r].IsArray()){
+                continue;
+            }
+            const auto& row = rows[r].GetArray();
+            for(int c = 0; c < static_cast<int>(row.Size()); c++){
+                tiles[r * width + c] = row[c].IsInt() ? row[c].GetInt() : 0;
+            }
+        }
+    }
+}
+
+
+void Tilemap::resize(int new_width, int new_height){
+    removeSprites();
+    width = new_width;
+    height = new_height;
+    tiles.assign(static_cast<size_t>(width) * height, 0);
+    static_ids.assign(tiles.size(), 0);
+    sprites_dirty = true;
+    colliders_dirty = true;
+}
+
+
+void Tilemap::SetTiles(luabridge::LuaRef rows){
+    if(!rows.isTable()){
+        return;
+    }
+    
+    int new_height = rows.length();
+    int new_width = 0;
+    for(int r = 1; r <= new_height; r++){
+        luabridge::LuaRef row = rows[r];
+        if(row.isTable()){
+            new_width = max(new_width, row.length());
+        }
+    }
+    resize(new_width, new_height);
+    
+    for(int r = 0; r < height; r++){
+        luabridge::LuaRef row = rows[r + 1];
+        if(!row.isTable()){
+            continue;
+        }
+        int length = row.length();
+        for(int c = 0; c < length; c++){
+            luabridge::LuaRef code = row[c + 1];
+            tiles[r * width + c] = code.isNumber() ? code.cast<int>() : 0;
+        }
+    }
+}
+
+
+void Tilemap::SetTileImage(int code, const std::string& image){
+    tile_images[code] = StringTable::Intern(image);
+    sprites_dirty = true;
+}
+
+
+void Tilemap::SetSolid(int code, bool solid){
+    solid_listed = true;
+    if(solid){
+        solid_codes.insert(code);
+    }else{
+        solid_codes.erase(code);
+    }
+    colliders_dirty = true;
+}
+
+
+int Tilemap::GetTile(int column, int row) const{
+    if(column < 1 || row < 1 || column > width || row > height){
+        return 0;
+    }
+    return tiles[(row - 1) * width + (column - 1)];
+}
+
+
+void Tilemap::SetTile(int column, int row, int code){
+    if(column < 1 || row < 1 || column > width || row > height){
+        return;
+    }
+    
+    int c = column - 1;
+    int r = row - 1;
+    bool was_solid = isSolid(c, r);
+    tiles[r * width + c] = code;
+    
+    if(onStart_called && enabled && StaticLayer::enabled && Renderer::getRenderer() && !sprites_dirty){
+        syncTile(c, r);
+    }
+    if(isSolid(c, r) != was_solid){
+        colliders_dirty = true;
+    }
+}
+
+
+bool Tilemap::isSolid(int column, int row) const{
+    if(column < 0 || row < 0 || column >= width || row >= height){
+        return false;
+    }
+    int code = tiles[row * width + column];
+    if(code == 0){
+        return false;
+    }
+    return !solid_listed || solid_codes.count(code) > 0;
+}
+
+
+// Images are stretched to tile_size, so sprites tile seamlessly whatever their pixel size
+ImageRenderRequest Tilemap::tileRequest(int column, int row) const{
+    ImageRenderRequest request;
+    request.image = tile_images.at(tiles[row * width + column]);
+    
+    const ImageEntry& image = ImageDB::loadImage(Renderer::getRenderer(), request.image);
+    request.scale_x = tile_size * 100.0f / image.src.w;
+    request.scale_y = tile_size * 100.0f / image.src.h;
+    
+    request.x = x + column * tile_size;
+    request.y = y + row * tile_size;
+    request.sorting_order = sorting_order;
+    return request;
+}
+
+
+void Tilemap::syncSprites(){
+    static_epoch = StaticLayer::getEpoch();
+    for(int r = 0; r < height; r++){
+        for(int c = 0; c < width; c++){
+            syncTile(c, r);
+        }
+    }
+    sprites_dirty = false;
+}
+
+
+void Tilemap::syncTile(int column, int row){
+    uint64_t& id = static_ids[row * width + column];
+    
+    if(tile_images.find(tiles[row * width + column]) == tile_images.end()){
+        if(id){
+            StaticLayer::remove(id);
+            id = 0;
+        }
+        return;
+    }
+    
+    ImageRenderRequest request = tileRequest(column, row);
+    if(!id || !StaticLayer::update(id, request)){
+        id = StaticLayer::add(request);
+    }
+    sprites_registered = sprites_registered || id != 0;
+}
+
+
+void Tilemap::removeSprites(){
+    for(uint64_t& id : static_ids){
+        if(id){
+            StaticLayer::remove(id);
+            id = 0;
+        }
+    }
+    sprites_registered = false;
+}
+
+
+// Per-frame fallback while the static layer is off (RENDERLOGGER / AUTOGRADER)
+void Tilemap::drawTiles(){
+    for(int r = 0; r < height; r++){
+        for(int c = 0; c < width; c++){
+            if(tile_images.find(tiles[r * width + c]) == tile_images.end()){
+                continue;
+            }
+            ImageRenderRequest request = tileRequest(c, r);
+            Renderer::DrawEx(request.image, request.x, request.y, 0.0f, request.scale_x, request.scale_y, 0.5f, 0.5f, 255.0f, 255.0f, 255.0f, 255.0f, static_cast<float>(sorting_order));
+        }
+    }
+}
+
+
+// Traces the outline of every solid region along the grid lines. Each boundary edge runs with its
+// solid tile on the left, so outer loops wind counter-clockwise and holes clockwise, which is what
+// one-sided chain edges need for their normals to face the empty side. Where two solid tiles only
+// touch at a corner the trace turns left, keeping them as separate loops.
+void Tilemap::buildColliders(){
+    colliders_dirty = false;
+    loop_count = 0;
+    
+    if(body && RigidbodyManager::physics_world){
+        RigidbodyManager::physics_world->DestroyBody(body);
+    }
+    body = nullptr;
+    
+    if(!has_collider || tiles.empty()){
+        return;
+    }
+    
+    struct Edge {
+        int from;
+        int to;
+        bool used;
+    };
+    
+    int stride = width + 1;
+    vector<Edge> edges;
+    vector<array<int, 2>> outgoing(static_cast<size_t>(stride) * (height + 1), {-1, -1});
+    
+    auto add_edge = [&](int from_x, int from_y, int to_x, int to_y){
+        int from = from_y * stride + from_x;
+        outgoing[from][outgoing[from][0] < 0 ? 0 : 1] = static_cast<int>(edges.size());
+        edges.push_back({from, to_y * stride + to_x, false});
+    };
+    
+    for(int r = 0; r < height; r++){
+        for(int c = 0; c < width; c++){
+            if(!isSolid(c, r)){
+                continue;
+            }
+            if(!isSolid(c, r - 1)){
+                add_edge(c, r, c + 1, r);
+            }
+            if(!isSolid(c + 1, r)){
+                add_edge(c + 1, r, c + 1, r + 1);
+            }
+            if(!isSolid(c, r + 1)){
+                add_edge(c + 1, r + 1, c, r + 1);
+            }
+            if(!isSolid(c - 1, r)){
+                add_edge(c, r + 1, c, r);
+            }
+        }
+    }
+    
+    if(edges.empty()){
+        return;
+    }
+    
+    auto direction = [&](int from, int to){
+        return make_pair(to % stride - from % stride, to / stride - from / stride);
+    };
+    
+    if(!RigidbodyManager::has_been_initialized){
+        RigidbodyManager::Initialize();
+    }
+    
+    b2BodyDef body_def;
+    body_def.type = b2_staticBody;
+    body = RigidbodyManager::physics_world->CreateBody(&body_def);
+    
+    vector<int> loop;
+    vector<b2Vec2> points;
+    
+    for(size_t start = 0; start < edges.size(); start++){
+        if(edges[start].used){
+            continue;
+        }
+        
+        loop.clear();
+        int edge = static_cast<int>(start);
+        while(edge >= 0 && !edges[edge].used){
+            edges[edge].used = true;
+            loop.push_back(edges[edge].from);
+            
+            const array<int, 2>& next = outgoing[edges[edge].to];
+            int chosen = next[0];
+            if(next[1] >= 0){
+                auto [dx, dy] = direction(edges[edge].from, edges[edge].to);
+                auto [nx, ny] = direction(edges[next[0]].from, edges[next[0]].to);
+                chosen = (nx == -dy && ny == dx) ? next[0] : next[1];
+            }
+            edge = chosen;
+        }
+        
+        // Only corners become chain vertices
+        points.clear();
+        size_t count = loop.size();
+        for(size_t i = 0; i < count; i++){
+            int previous = loop[(i + count - 1) % count];
+            int current = loop[i];
+            int following = loop[(i + 1) % count];
+            if(direction(previous, current) == direction(current, following)){
+                continue;
+            }
+            points.push_back(b2Vec2(x + (current % stride - 0.5f) * tile_size, y + (current / stride - 0.5f) * tile_size));
+        }
+        
+        if(points.size() < 3){
+            continue;
+        }
+        
+        b2ChainShape chain;
+        chain.CreateLoop(points.data(), static_cast<int32>(points.size()));
+        
+        b2FixtureDef fixture_def;
+        fixture_def.shape = &chain;
+        fixture_def.friction = collider_friction;
+        fixture_def.restitution = collider_bounciness;
+        fixture_def.filter.categoryBits = 0x0001;
+        fixture_def.filter.maskBits = 0x0001;
+        fixture_def.userData.pointer = reinterpret_cast<uintptr_t>(actor);
+        body->CreateFixture(&fixture_def);
+        
+        loop_count++;
+    }
+}
@@ -0,0 +1,97 @@
+//
+//  Tilemap.hpp
+//  game_engine
+//
+//  Created by Stanley  on 5/4/25.
+//
+
+#ifndef Tilemap_hpp
+#define Tilemap_hpp
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "lua/lua.hpp"
+#include "LuaBridge/LuaBridge.h"
+#include "box2d/box2d.h"
+#include "StaticLayer.hpp"
+
+class Actor;
+
+
+// A whole grid level as one component. Tiles are drawn through the StaticLayer, so the grid is
+// rendered into chunk textures once, and solid tiles are merged into one static body holding a
+// chain loop per connected region (holes get their own inward-facing loop).
+// Tiles come from resources/tilemaps/<map>.json ({"tiles": [[...]], "images": {"1": "box2"},
+// "solid": [1]}) or from Lua through SetTiles / SetTileImage / SetSolid. Rows and columns are
+// 1-based like a Lua table, tile (1, 1) is centered on (x, y) and the row index grows along +y.
+// Tiles are tile_size world units square, images are scaled to fit.
+class Tilemap {
+public:
+    bool enabled = true;
+    std::string key = "???";
+    Actor* actor = nullptr;
+    std::string type = "Tilemap";
+    bool onStart_called = false;
+    
+    float x = 0.0f;
+    float y = 0.0f;
+    float tile_size = 1.0f;
+    int sorting_order = 0;
+    
+    std::string map = "";
+    
+    bool has_collider = true;
+    float collider_friction = 0.3f;
+    float collider_bounciness = 0.3f;
+    
+    void OnStart();
+    void OnUpdate();
+    void OnDestroy();
+    
+    // rows[row][column] tile codes, 0 is empty
+    void SetTiles(luabridge::LuaRef rows);
+    void SetTileImage(int code, const std::string& image);
+    // Without any SetSolid (or "solid" list) every non-zero code is solid
+    void SetSolid(int code, bool solid);
+    
+    int GetTile(int column, int row) const;
+    void SetTile(int column, int row, int code);
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    int GetLoopCount() const { return loop_count; }
+    
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<int> tiles;
+    
+    std::unordered_map<int, uint32_t> tile_images;
+    std::unordered_set<int> solid_codes;
+    bool solid_listed = false;
+    
+    // One StaticLayer id per tile, 0 where nothing is drawn
+    std::vector<uint64_t> static_ids;
+    int static_epoch = 0;
+    bool sprites_dirty = true;
+    bool sprites_registered = false;
+    
+    b2Body* body = nullptr;
+    bool colliders_dirty = true;
+    int loop_count = 0;
+    
+    void loadMap();
+    void resize(int new_width, int new_height);
+    bool isSolid(int column, int row) const;
+    ImageRenderRequest tileRequest(int column, int row) const;
+    
+    void syncSprites();
+    void syncTile(int column, int row);
+    void removeSprites();
+    void drawTiles();
+    
+    void buildColliders();
+};
+
+#endif /* Tilemap_hpp */
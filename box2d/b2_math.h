@@ -151,6 +151,16 @@ struct B2_API b2Vec2
         
         return result;
     }
+    
+    void AddInPlace (const b2Vec2& other){
+        x += other.x;
+        y += other.y;
+    }
+    
+    void ScaleInPlace (const float multiplier){
+        x *= multiplier;
+        y *= multiplier;
+    }
 
 	float x, y;
 };
@@ -0,0 +1,38 @@
+-- Lua heap growth per OnUpdate of the shipped movement scripts.
+-- Set "initial_scene": "benchmark_allocations" in game.config; logs one line per script and quits.
+AllocationBenchmark = {
+	warmup_frames = 10,
+	calls = 1000,
+
+	OnStart = function(self)
+		Actor.Instantiate("Player")
+		self.frame = 0
+	end,
+
+	OnUpdate = function(self)
+		-- Lets the player's OnStart run and both scripts settle on their steady-state path
+		self.frame = self.frame + 1
+		if self.frame < self.warmup_frames then
+			return
+		end
+
+		self:Measure("KeyboardControls", Actor.Find("player"):GetComponent("KeyboardControls"))
+		self:Measure("CameraManager", Actor.Find("camera"):GetComponent("CameraManager"))
+		Application.Quit()
+	end,
+
+	-- The collector is stopped while measuring so nothing is freed between the two counts
+	Measure = function(self, name, component)
+		collectgarbage("collect")
+		collectgarbage("stop")
+		local before = collectgarbage("count")
+		for i = 1, self.calls do
+			component:OnUpdate()
+		end
+		local after = collectgarbage("count")
+		collectgarbage("restart")
+
+		Debug.Log(string.format("AllocationBenchmark: %s.OnUpdate allocates %.1f bytes per call over %d calls",
+			name, (after - before) * 1024 / self.calls, self.calls))
+	end
+}
@@ -0,0 +1,56 @@
+-- Texture binds with and without the atlas. Set "initial_scene": "benchmark_atlas" in game.config,
+-- then run once with "texture_atlas": true and once with false in rendering.config.
+AtlasBenchmark = {
+	sprite_count = 2000,
+	warmup_frames = 30,
+	sample_frames = 300,
+
+	OnStart = function(self)
+		self.images = {
+			Image.Handle("box1"), Image.Handle("box2"), Image.Handle("box3"),
+			Image.Handle("box4"), Image.Handle("circle")
+		}
+		self.frame = 0
+		self.texture_binds = 0
+		self.draw_calls = 0
+	end,
+
+	OnUpdate = function(self)
+		-- Images interleaved every sprite, the worst case for binds when each one is its own texture
+		local images = self.images
+		local image_count = #images
+		for i = 0, self.sprite_count - 1 do
+			local x = -4.5 + (i % 50) * 0.18
+			local y = -2.5 + (i // 50 % 40) * 0.125
+			Image.DrawEx(images[i % image_count + 1], x, y, 0, 0.2, 0.2, 0.5, 0.5, 255, 255, 255, 255, 0)
+		end
+
+		-- Stats are from the previous frame
+		self.frame = self.frame + 1
+		if self.frame <= self.warmup_frames then
+			return
+		end
+
+		local stats = Image.GetStats()
+		self.texture_binds = self.texture_binds + stats.texture_binds
+		self.draw_calls = self.draw_calls + stats.draw_calls
+
+		if self.frame == self.warmup_frames + self.sample_frames then
+			self:Report()
+			Application.Quit()
+		end
+	end,
+
+	Report = function(self)
+		local pages = Image.GetAtlasReport()
+		Debug.Log(string.format("AtlasBenchmark: texture_atlas %s, %d sprites over %d frames",
+			#pages > 0 and "on" or "off", self.sprite_count, self.sample_frames))
+		Debug.Log(string.format("AtlasBenchmark: %.1f texture_binds, %.1f draw_calls per frame",
+			self.texture_binds / self.sample_frames, self.draw_calls / self.sample_frames))
+
+		for i, page in ipairs(pages) do
+			Debug.Log(string.format("AtlasBenchmark: page %d, %dx%d, %d images, %.1f%% occupied",
+				i, page.size, page.size, page.images, page.occupancy * 100))
+		end
+	end
+}
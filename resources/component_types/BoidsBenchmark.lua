@@ -0,0 +1,95 @@
+-- Bulk Physics.GetPositions / SetVelocities against per-body GetPosition / SetVelocity.
+-- Set "initial_scene": "benchmark_boids" in game.config; the two modes take turns in blocks of
+-- frames so both see the same scene, then the averages are logged and the game quits.
+BoidsBenchmark = {
+	agent_count = 5000,
+	warmup_frames = 10,
+	block_frames = 60,
+	rounds = 3,
+
+	OnStart = function(self)
+		self.agents = {}
+		self.bodies = {}
+		self.velocities = {}
+
+		for i = 1, self.agent_count do
+			local agent = Actor.Instantiate("Boid")
+			local rb = agent:GetComponent("Rigidbody")
+			rb.x = math.random() * 40 - 20
+			rb.y = math.random() * 40 - 20
+
+			self.agents[i] = agent
+			self.bodies[i] = rb
+			self.velocities[i * 2 - 1] = math.random() * 2 - 1
+			self.velocities[i * 2] = math.random() * 2 - 1
+		end
+
+		self.frame = 0
+		self.seconds = { bulk = 0, per_body = 0 }
+		self.frames = { bulk = 0, per_body = 0 }
+	end,
+
+	OnUpdate = function(self)
+		-- The bodies only exist once every Rigidbody has run OnStart
+		self.frame = self.frame + 1
+		if self.frame <= self.warmup_frames then
+			return
+		end
+
+		local block = (self.frame - self.warmup_frames - 1) // self.block_frames
+		if block >= self.rounds * 2 then
+			self:Report()
+			Application.Quit()
+			return
+		end
+
+		local mode = block % 2 == 0 and "bulk" or "per_body"
+		local start = os.clock()
+		if mode == "bulk" then
+			self:UpdateBulk()
+		else
+			self:UpdatePerBody()
+		end
+		self.seconds[mode] = self.seconds[mode] + (os.clock() - start)
+		self.frames[mode] = self.frames[mode] + 1
+	end,
+
+	-- Each agent is pulled towards the origin, same math in both modes so only the bindings differ
+	UpdateBulk = function(self)
+		local velocities = self.velocities
+		local positions = Physics.GetPositions(self.agents, self.positions)
+		self.positions = positions
+
+		for i = 1, self.agent_count do
+			local vx = velocities[i * 2 - 1] - positions[i * 2 - 1] * 0.01
+			local vy = velocities[i * 2] - positions[i * 2] * 0.01
+			velocities[i * 2 - 1] = vx
+			velocities[i * 2] = vy
+		end
+
+		Physics.SetVelocities(self.agents, velocities)
+	end,
+
+	UpdatePerBody = function(self)
+		local velocities = self.velocities
+		local bodies = self.bodies
+
+		for i = 1, self.agent_count do
+			local position = bodies[i]:GetPosition()
+			local vx = velocities[i * 2 - 1] - position.x * 0.01
+			local vy = velocities[i * 2] - position.y * 0.01
+			velocities[i * 2 - 1] = vx
+			velocities[i * 2] = vy
+			bodies[i]:SetVelocity(Vector2(vx, vy))
+		end
+	end,
+
+	Report = function(self)
+		local bulk_ms = self.seconds.bulk * 1000 / self.frames.bulk
+		local per_body_ms = self.seconds.per_body * 1000 / self.frames.per_body
+
+		Debug.Log(string.format("BoidsBenchmark: %d agents, %d frames per mode", self.agent_count, self.frames.bulk))
+		Debug.Log(string.format("BoidsBenchmark: bulk %.3f ms, per-body %.3f ms per frame (%.1fx)",
+			bulk_ms, per_body_ms, per_body_ms / bulk_ms))
+	end
+}
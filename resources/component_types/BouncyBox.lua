@@ -3,9 +3,8 @@ BouncyBox = {
 	OnCollisionEnter = function(self, collision)
 		if collision.other:GetName() == "player" then
 			local rb = collision.other:GetComponent("Rigidbody")
-			local current_vel = rb:GetVelocity()
-			local new_vel = Vector2(current_vel.x, -15)
-			rb:SetVelocity(new_vel)
+			local current_vel_x = rb:GetVelocityXY()
+			rb:SetVelocityXY(current_vel_x, -15)
 		end
 	end
 }
@@ -29,6 +29,23 @@ GameManager = {
 	},
 
 	OnStart = function(self)
+		-- Static boxes become one Tilemap: cached chunk rendering and a few merged colliders
+		-- instead of an actor and body per tile
+		local solid_rows = {}
+		for y = 1, 20 do
+			solid_rows[y] = {}
+			for x = 1, 20 do
+				solid_rows[y][x] = self.stage1[y][x] == 1 and 1 or 0
+			end
+		end
+
+		local tilemap = self.actor:AddComponent("Tilemap")
+		tilemap.x = 1
+		tilemap.y = 1
+		tilemap.sorting_order = -999
+		tilemap:SetTileImage(1, "box2")
+		tilemap:SetTiles(solid_rows)
+
 		-- Spawn stage
 		for y=1,20 do 
 			for x = 1,20 do
@@ -40,12 +57,6 @@ GameManager = {
 					local new_player_rb = new_player:GetComponent("Rigidbody")
 					new_player_rb.x = tile_pos.x
 					new_player_rb.y = tile_pos.y
-				
-				elseif tile_code == 1 then
-					local new_box = Actor.Instantiate("KinematicBox")
-					local new_box_rb = new_box:GetComponent("Rigidbody")
-					new_box_rb.x = tile_pos.x
-					new_box_rb.y = tile_pos.y
 
 				elseif tile_code == 3 then
 					local new_box = Actor.Instantiate("BouncyBox")
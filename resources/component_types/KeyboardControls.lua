@@ -6,15 +6,26 @@ KeyboardControls = {
     
     OnStart = function(self)
         self.rb = self.actor:GetComponent("Rigidbody")
+        
+        -- Reused every frame so movement doesn't allocate new Vector2s
+        self.ray_origin = Vector2(0, 0)
+        self.ray_direction = Vector2(0, 1)
+        self.force = Vector2(0, 0)
+        
+        -- Key names resolved once, the per-frame checks are then plain array reads
+        self.key_right = Input.Key("right")
+        self.key_left = Input.Key("left")
+        self.key_up = Input.Key("up")
+        self.key_space = Input.Key("space")
     end,
     
     OnUpdate = function(self)
         local horizontal_input = 0
-        if Input.GetKey("right") then
+        if Input.GetKey(self.key_right) then
             horizontal_input = self.speed
         end
         
-        if Input.GetKey("left") then
+        if Input.GetKey(self.key_left) then
             horizontal_input = -self.speed
         end
         
@@ -37,9 +48,10 @@ KeyboardControls = {
         local vertical_input = 0
         
         local on_ground = false
-        ground_object = Physics.Raycast(self.rb:GetPosition(), Vector2(0, 1), 1)
+        self.ray_origin:Set(self.rb:GetPositionXY())
+        ground_object = Physics.Raycast(self.ray_origin, self.ray_direction, 1)
         
-        if Input.GetKeyDown("up") or Input.GetKeyDown("space") then
+        if Input.GetKeyDown(self.key_up) or Input.GetKeyDown(self.key_space) then
             if ground_object ~= nil then
                 vertical_input = -self.jump_power
             end
@@ -56,6 +68,7 @@ KeyboardControls = {
             end
         end
         
-        self.rb:AddForce(Vector2(horizontal_input, vertical_input))
+        self.force:Set(horizontal_input, vertical_input)
+        self.rb:AddForce(self.force)
     end
 }
\ No newline at end of file
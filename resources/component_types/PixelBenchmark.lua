@@ -0,0 +1,59 @@
+-- 100k Image.DrawPixel calls a frame under both pixel modes.
+-- Set "initial_scene": "benchmark_pixels" in game.config; the modes take turns in blocks of frames
+-- through Image.SetPixelMode, then frame time and draw_calls per mode are logged and the game quits.
+-- Frame time is os.clock between OnUpdates, so it counts CPU time and leaves out vsync waits.
+PixelBenchmark = {
+	width = 400,
+	height = 250,
+	warmup_frames = 10,
+	block_frames = 60,
+	rounds = 3,
+
+	OnStart = function(self)
+		self.frame = 0
+		self.seconds = { runs = 0, texture = 0 }
+		self.draw_calls = { runs = 0, texture = 0 }
+		self.frames = { runs = 0, texture = 0 }
+	end,
+
+	OnUpdate = function(self)
+		-- The time since the last OnUpdate covers the frame that mode rendered, which GetStats describes
+		local now = os.clock()
+		local last_mode = self.mode
+		if self.frame > self.warmup_frames then
+			self.seconds[last_mode] = self.seconds[last_mode] + (now - self.last_clock)
+			self.draw_calls[last_mode] = self.draw_calls[last_mode] + Image.GetStats().draw_calls
+			self.frames[last_mode] = self.frames[last_mode] + 1
+		end
+		self.last_clock = now
+		self.frame = self.frame + 1
+
+		local block = math.max(self.frame - self.warmup_frames - 1, 0) // self.block_frames
+		if block >= self.rounds * 2 then
+			self:Report()
+			Application.Quit()
+			return
+		end
+
+		self.mode = block % 2 == 0 and "runs" or "texture"
+		Image.SetPixelMode(self.mode)
+
+		-- Color steps every 16 pixels along a row, so runs mode batches short runs rather than one big one
+		local left, top = 280, 145
+		for y = 0, self.height - 1 do
+			for x = 0, self.width - 1 do
+				local shade = (x // 16 * 24 + y) % 256
+				Image.DrawPixel(left + x, top + y, shade, 255 - shade, 128, 255)
+			end
+		end
+	end,
+
+	Report = function(self)
+		Debug.Log(string.format("PixelBenchmark: %d pixels, %d frames per mode", self.width * self.height, self.frames.runs))
+
+		for _, mode in ipairs({ "runs", "texture" }) do
+			Debug.Log(string.format("PixelBenchmark: pixel_mode %s, %.3f ms per frame, %.1f draw_calls per frame",
+				mode, self.seconds[mode] * 1000 / self.frames[mode], self.draw_calls[mode] / self.frames[mode]))
+		end
+	end
+}
@@ -6,6 +6,10 @@ SpriteRenderer = {
 	a = 255,
 	sorting_order = 0,
 
+	-- Drawn once into the static layer and only re-sent when something changes.
+	-- Falls back to per-frame drawing when the static layer is off.
+	static = false,
+
 	OnStart = function(self)
 		self.pos = Vector2(0, 0)
 		self.rot_degrees = 0
@@ -15,11 +19,62 @@ SpriteRenderer = {
 		self.rb = self.actor:GetComponent("Rigidbody")
 
 		if self.rb ~= nil then
-			self.pos = self.rb:GetPosition()
+			self.pos:Set(self.rb:GetPositionXY())
 			self.rot_degrees = self.rb:GetRotation()
 		end
 
-		Image.DrawEx(self.sprite, self.pos.x, self.pos.y, self.rot_degrees, 1.0, 1.0, 0.5, 0.5, self.r, self.g, self.b, self.a, self.sorting_order)
+		-- Re-resolved only when another script swaps the sprite
+		if self.sprite ~= self.resolved_sprite then
+			self.sprite_handle = Image.Handle(self.sprite)
+			self.resolved_sprite = self.sprite
+		end
+
+		if self.static and self:UpdateStatic() then
+			return
+		end
+
+		Image.DrawEx(self.sprite_handle, self.pos.x, self.pos.y, self.rot_degrees, 1.0, 1.0, 0.5, 0.5, self.r, self.g, self.b, self.a, self.sorting_order)
+	end,
+
+	-- False when the static layer is off and the sprite has to be drawn normally
+	UpdateStatic = function(self)
+		-- A scene load drops the layer, preserved actors add themselves again
+		if self.static_id ~= nil and self.static_epoch ~= Image.GetStaticEpoch() then
+			self.static_id = nil
+		end
+
+		local last = self.static_last
+		if self.static_id ~= nil and last.sprite == self.sprite_handle and last.x == self.pos.x and last.y == self.pos.y
+			and last.rot == self.rot_degrees and last.r == self.r and last.g == self.g and last.b == self.b and last.a == self.a
+			and last.sorting_order == self.sorting_order then
+			return true
+		end
+
+		if self.static_id == nil or not Image.UpdateStatic(self.static_id, self.sprite_handle, self.pos.x, self.pos.y, self.rot_degrees, 1.0, 1.0, 0.5, 0.5, self.r, self.g, self.b, self.a, self.sorting_order) then
+			self.static_id = Image.AddStatic(self.sprite_handle, self.pos.x, self.pos.y, self.rot_degrees, 1.0, 1.0, 0.5, 0.5, self.r, self.g, self.b, self.a, self.sorting_order)
+			self.static_epoch = Image.GetStaticEpoch()
+
+			-- Layer is off for this run, stop asking
+			if self.static_id == nil then
+				self.static = false
+				return false
+			end
+		end
+
+		if last == nil then
+			last = {}
+			self.static_last = last
+		end
+		last.sprite, last.x, last.y, last.rot = self.sprite_handle, self.pos.x, self.pos.y, self.rot_degrees
+		last.r, last.g, last.b, last.a, last.sorting_order = self.r, self.g, self.b, self.a, self.sorting_order
+
+		return self.static_id ~= nil
+	end,
+
+	OnDestroy = function(self)
+		if self.static_id ~= nil then
+			Image.RemoveStatic(self.static_id)
+			self.static_id = nil
+		end
 	end
 }
-